@@ -144,8 +144,11 @@ switch lower(opts.diffusivity)
 end
 
 if opts.sigma > 0
-    temp = imfilter( ...
-        in, fspecial('gaussian', [7 7], opts.sigma), 'symmetric', 'same');
+    % The Gaussian is separable, two 1D passes cost 14 instead of 49
+    % operations per pixel.
+    g = fspecial('gaussian', [7 1], opts.sigma);
+    temp = imfilter(imfilter(in, g, 'symmetric', 'same'), ...
+        g', 'symmetric', 'same');
 else
     temp = in;
 end
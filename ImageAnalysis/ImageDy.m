@@ -176,19 +176,22 @@ else
     
 end
 
-% Ues a convolution to compute the image derivatives.
+% Ues a convolution to compute the image derivatives. The 3x3 stencils are
+% separable. conv2(u, v, A) filters the columns with u and the rows with v,
+% which costs 6 instead of 9 operations per pixel. Since conv2 convolves
+% while filter2 correlates, u and v are the flipped factors of the stencils.
 switch opts.scheme
     
     case 'forward'
-        out = filter2( [0 0 0 ; 0 -1 0 ; 0 1 0]/hy, ...
+        out = conv2( [1 -1 0]/hy, [0 1 0], ...
            out, 'valid' );
     
     case 'backward'
-        out = filter2( [0 -1 0 ; 0 1 0 ; 0 0 0]/hy, ...
+        out = conv2( [0 1 -1]/hy, [0 1 0], ...
             out, 'valid' );
     
     case 'central'
-        out = filter2( [0 -1 0 ; 0 0 0 ; 0 1 0]/(2*hy), ...
+        out = conv2( [1 0 -1]/(2*hy), [0 1 0], ...
             out, 'valid' );
     
     case 'central-4'
@@ -196,11 +199,11 @@ switch opts.scheme
             out, 'valid' );
     
     case 'sobel'
-        out = filter2( [-1 -2 -1 ; 0 0 0 ; 1 2 1]/(8*hy), ...
+        out = conv2( [1 0 -1]/(8*hy), [1 2 1], ...
             out, 'valid' );
     
     case 'scharr'
-        out = filter2( [-3 -10 -3 ; 0 0 0 ; 3 10 3]/(32*hy), ...
+        out = conv2( [1 0 -1]/(32*hy), [3 10 3], ...
             out, 'valid' );
     
     case 'user-specified'
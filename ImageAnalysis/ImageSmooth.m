@@ -94,15 +94,26 @@ opts = parser.Results;
 
 %% Algorithm
 
+% The average and gaussian filters are separable and applied as a column and
+% a row filter. A m x n filter then costs m+n instead of m*n operations per
+% pixel.
 switch opts.filter
     case 'average'
-        h = fspecial(opts.filter, opts.averageSize);
+        siz = opts.averageSize.*[1 1];
+        hc = fspecial(opts.filter, [siz(1) 1]);
+        hr = fspecial(opts.filter, [1 siz(2)]);
     case 'disk'
         h = fspecial(opts.filter, opts.diskSize);
     case 'gaussian'
-        h = fspecial(opts.filter, opts.gaussianSize, opts.gaussianSigma);
+        siz = opts.gaussianSize.*[1 1];
+        hc = fspecial(opts.filter, [siz(1) 1], opts.gaussianSigma);
+        hr = fspecial(opts.filter, [1 siz(2)], opts.gaussianSigma);
 end
 
-out = imfilter(in,h,'symmetric','same');
+if strcmp(opts.filter, 'disk')
+    out = imfilter(in,h,'symmetric','same');
+else
+    out = imfilter(imfilter(in,hc,'symmetric','same'),hr,'symmetric','same');
+end
 
 end
@@ -106,8 +106,11 @@ opts = parser.Results;
 
 % Smooth input image
 if opts.sigma > 0
-    temp = imfilter( ...
-        in, fspecial('gaussian', [7 7], opts.sigma), 'symmetric', 'same');
+    % The Gaussian is separable, two 1D passes cost 14 instead of 49
+    % operations per pixel.
+    g = fspecial('gaussian', [7 1], opts.sigma);
+    temp = imfilter(imfilter(in, g, 'symmetric', 'same'), ...
+        g', 'symmetric', 'same');
 else
     temp = in;
 end
@@ -127,12 +130,10 @@ out(:,:,3) = grad(:,:,2).^2;
 
 % Smooth the entries in the tensor nabla(u).nabla(u)'
 if opts.rho > 0
-    out(:,:,1) = imfilter( out(:,:,1), ...
-        fspecial('gaussian', [7 7], opts.rho), 'symmetric', 'same');
-    out(:,:,2) = imfilter( out(:,:,2), ...
-        fspecial('gaussian', [7 7], opts.rho), 'symmetric', 'same');
-    out(:,:,3) = imfilter( out(:,:,3), ...
-        fspecial('gaussian', [7 7], opts.rho), 'symmetric', 'same');
+    % All three components at once, each smoothed with two 1D passes.
+    g = fspecial('gaussian', [7 1], opts.rho);
+    out = imfilter(imfilter(out, g, 'symmetric', 'same'), ...
+        g', 'symmetric', 'same');
 end
 
 end
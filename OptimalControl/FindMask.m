@@ -18,7 +18,7 @@ function [u, c] = FindMask(f, lambda, varargin)
 
 %% Check Input and Output
 
-narginchk(2, 22);
+narginchk(2, 30);
 nargoutchk(0, 8);
 
 parser = inputParser;
@@ -41,6 +41,12 @@ parser.addParameter('kkt',      false,         @(x) validateattributes(x, {'logi
 parser.addParameter('operator', 'laplace',     @(x) strcmpi(x, validatestring( x, {'laplace', 'biharmonic'},                                       mfilename, 'operator')));
 parser.addParameter('PockIt',   25000,         @(x) validateattributes(x, {'numeric'}, {'scalar', 'nonempty', 'finite', 'nonnegative'},            mfilename, 'PockIt'));
 parser.addParameter('PockTol',  1e-12,         @(x) validateattributes(x, {'numeric'}, {'scalar', 'nonempty', 'finite', 'nonnegative'},            mfilename, 'PockTol'));
+parser.addParameter('PockGamma', 0,            @(x) validateattributes(x, {'numeric'}, {'scalar', 'nonempty', 'finite', 'nonnegative'},            mfilename, 'PockGamma'));
+parser.addParameter('PockAdapt', 0.5,          @(x) validateattributes(x, {'numeric'}, {'scalar', 'nonempty', 'finite', 'nonnegative', '<', 1},    mfilename, 'PockAdapt'));
+parser.addParameter('matrixfree', true,        @(x) validateattributes(x, {'logical'}, {'scalar'},                                                 mfilename, 'matrixfree'));
+parser.addParameter('warmstart', true,         @(x) validateattributes(x, {'logical'}, {'scalar'},                                                 mfilename, 'warmstart'));
+parser.addParameter('PockPrecision', 'double', @(x) strcmpi(x, validatestring( x, {'double', 'single', 'mixed'},                              mfilename, 'PockPrecision')));
+parser.addParameter('PockPolish', true,        @(x) validateattributes(x, {'logical'}, {'scalar'},                                                 mfilename, 'PockPolish'));
 
 parser.parse( f, lambda, varargin{:});
 opts = parser.Results;
@@ -63,6 +69,13 @@ c       = inf(ro,co);
 i       = 1;
 cbar    = opts.cInit;
 
+% The solver context keeps the iterates and the operator norm estimate of
+% the previous outer iteration as warm start.
+if opts.warmstart
+    pdhg = PockChambolleCtxMex('new', N);
+    pdhgCleanup = onCleanup(@() PockChambolleCtxMex('delete', pdhg));
+end
+
 %% Run Code.
 
 if opts.plot || opts.logging
@@ -115,7 +128,11 @@ while i <= opts.maxit
     
     % Note that A is the inpainting matrix.
     % A = C - (I-C)*D;
-    A = spdiags(ToVec(cbar), 0, N, N) - (I - spdiags(ToVec(cbar), 0, N, N))*D;
+    % In matrix free mode, the solver applies A directly from cbar and the
+    % matrix is only needed for the KKT checks.
+    if ~opts.matrixfree || opts.kkt
+        A = spdiags(ToVec(cbar), 0, N, N) - (I - spdiags(ToVec(cbar), 0, N, N))*D;
+    end
     
     % B = u - f + D*u;
     bb = ToVec(ubar-f) + D*ToVec(ubar);
@@ -126,7 +143,17 @@ while i <= opts.maxit
     % - Solve optimisation problem to get new mask ----------------------- %
     
     tic();
-    [utemp, c, j, du, dc] = PockChambolleMex( ToVec(f), ToVec(cbar), A, A', bb, g, opts.e, opts.mu, opts.lambda, opts.PockIt, opts.PockTol);
+    if opts.matrixfree
+        % D = LaplaceM(ro,co) labels the grid column wise with ro rows.
+        Aarg = {[ro co], lower(opts.operator)};
+    else
+        Aarg = {A, []};
+    end
+    if opts.warmstart
+        [utemp, c, j, du, dc] = PockChambolleCtxMex( 'solve', pdhg, ToVec(f), ToVec(cbar), Aarg{:}, bb, g, opts.e, opts.mu, opts.lambda, opts.PockIt, opts.PockTol, opts.PockGamma, opts.PockAdapt, lower(opts.PockPrecision), opts.PockPolish);
+    else
+        [utemp, c, j, du, dc] = PockChambolleMex( ToVec(f), ToVec(cbar), Aarg{:}, bb, g, opts.e, opts.mu, opts.lambda, opts.PockIt, opts.PockTol, opts.PockGamma, opts.PockAdapt, lower(opts.PockPrecision), opts.PockPolish);
+    end
     
     if opts.kkt
         %% - Check KKT conditions for linearized problem. ---------------- %
@@ -234,7 +261,7 @@ while i <= opts.maxit
         fprintf(1, 'Density:\t\t%d / %d = %g percent.\n', sum(abs(c(:))>0.001), numel(c), 100*sum(abs(c(:))>0.001)/numel(c));
         fprintf(1, 'Chambolle iterations:\t\t%d\n', j);
         fprintf(1, 'Distance between Chambolle its.:\t%g, %g\n',du,dc);
-        fprintf(1, 'Duality gap in Chambolle alg.:\t%g\n',norm(A*utemp+bb.*ToVec(c)-g,2));
+        fprintf(1, 'Duality gap in Chambolle alg.:\t%g\n',norm(ToVec(cbar).*utemp-(1-ToVec(cbar)).*(D*utemp)+bb.*ToVec(c)-g,2));
         fprintf(1, 'Distance betwwen old an new c:\t%g.\n', norm(c(:)-cbar(:)));
         fprintf(1, 'Distance betwwen old an new u:\t%g.\n', norm(u(:)-ubar(:)));
         fprintf(1,'\n-----------------------------------------------------------------\n');
@@ -94,10 +94,11 @@ while i <= opts.maxit
     A = spdiags(ToVec(cbar), 0, N, N) - (I - spdiags(ToVec(cbar), 0, N, N))*D;
     
     % B = u - f + D*u;
-    bb = ToVec(ubar-f) + smvp(D,ToVec(ubar));
+    Du = smvp(D,ToVec(ubar));
+    bb = ToVec(ubar-f) + Du;
     
     % g = c*(I+D)*u
-    g = ToVec(cbar) .* smvp(( I + D ),ToVec(ubar));
+    g = ToVec(cbar) .* (ToVec(ubar) + Du);
     
     % - Solve optimisation problem to get new mask ----------------------- %
     
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+#include "mex.h"
+#include "matrix.h"
+#include "private/inpaintop.h"
+#include "private/opnorm.h"
+
+/* compile with -largeArrayDims flag. Add -fopenmp to CFLAGS and LDFLAGS to run
+ * the products on multiple threads.
+ */
+
+/* Estimates the 2-norm of K = [A B] with the Lanczos method applied to K*K'.
+ * This is the estimator used by the PDHG solvers, see private/opnorm.h.
+ *
+ * Signature:
+ * [nrm bnd k] = OpNormMex(A,B,tol,maxit)
+ *
+ * A     = sparse square matrix.
+ * B     = sparse matrix of the same size as A, or a vector with the diagonal
+ *         entries of B, or [] if K = A. The sign of B does not matter.
+ * tol   = relative tolerance (optional, default 1e-6).
+ * maxit = maximal number of Lanczos steps (optional, default 100).
+ *
+ * nrm   = estimate for the norm of K. This is a lower bound.
+ * bnd   = Ritz value plus residual. This is usually an upper bound for the
+ *         norm of K, but not a guaranteed one, see private/opnorm.h.
+ * k     = number of products with K and K'.
+ */
+
+void mexFunction(
+        int nlhs,       mxArray *plhs[],
+        int nrhs, const mxArray *prhs[]
+        )
+{
+    inpaintop A, B;
+    const double *b = NULL;
+    double tol = 1e-6, nrm, bnd;
+    int maxit = 100, k;
+    mwSize n;
+
+    if ((nrhs < 1) || (nrhs > 4)) {
+        mexErrMsgTxt("Incorrect number of inputs.");
+    }
+    if (nlhs > 3) {
+        mexErrMsgTxt("Incorrect number of outputs.");
+    }
+    if (!mxIsSparse(prhs[0])) {
+        mexErrMsgTxt("A must be a sparse matrix.");
+    }
+
+    n = mxGetM(prhs[0]);
+    inpaintop_init(&A, prhs[0], NULL, NULL, n);
+    memset(&B, 0, sizeof(inpaintop));
+
+    if ((nrhs > 1) && !mxIsEmpty(prhs[1])) {
+        if (mxIsSparse(prhs[1])) {
+            inpaintop_init(&B, prhs[1], NULL, NULL, n);
+        } else if (mxIsDouble(prhs[1]) && (mxGetNumberOfElements(prhs[1]) == n)) {
+            b = mxGetPr(prhs[1]);
+        } else {
+            mexErrMsgTxt("B must be a sparse matrix or the vector of its diagonal.");
+        }
+    }
+    if (nrhs > 2) { tol   = mxGetScalar(prhs[2]); }
+    if (nrhs > 3) { maxit = (int) mxGetScalar(prhs[3]); }
+
+    k = opnorm_estimate(&A, B.ir ? &B : NULL, b, NULL, maxit, tol, 0, NULL, &nrm, &bnd);
+
+    plhs[0] = mxCreateDoubleScalar(nrm);
+    if (nlhs > 1) { plhs[1] = mxCreateDoubleScalar(bnd); }
+    if (nlhs > 2) { plhs[2] = mxCreateDoubleScalar(k); }
+
+    inpaintop_free(&A);
+    inpaintop_free(&B);
+}
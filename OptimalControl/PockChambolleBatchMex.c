@@ -0,0 +1,181 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "mex.h"
+#include "matrix.h"
+#include "private/pdhg.h"
+
+/* compile with -largeArrayDims flag. Add -fopenmp to CFLAGS and LDFLAGS to
+ * solve the problems on multiple threads.
+ */
+
+/* Solves K independent problems of PockChambolleMex that share the grid size
+ * or the sparsity pattern of A in one call.
+ *
+ * Signature:
+ * [U C J DU DC] = PCB(F,CBAR,A,S,B,G,eps,mu,lambda,L,tol,gamma,alpha,prec,polish,reg,kappa)
+ * [U C J DU DC] = PCB(F,CBAR,[n1 n2],'laplace',B,G,eps,mu,lambda,L,tol,...)
+ * [U C J DU DC] = PCB(F,CBAR,[n1 n2],'biharmonic',B,G,eps,mu,lambda,L,tol,...)
+ *
+ * F, CBAR, B, G = n x K matrices, column k holds f, cbar, b and g of problem k.
+ * A             = sparse matrix A of the first problem. The other problems
+ *                 must have the same sparsity pattern.
+ * S             = nnz(A) x K matrix with the non-zero entries of A for every
+ *                 problem, in the order of A(:). If S is [], all problems use
+ *                 the entries of A.
+ *
+ * The remaining arguments are those of PockChambolleMex and apply to all
+ * problems. Only double precision is supported.
+ *
+ * U, C          = n x K matrices with the solutions.
+ * J, DU, DC     = 1 x K vectors with the number of iterations and the final
+ *                 changes of the iterates for every problem.
+ *
+ * Every problem is solved by a single thread. The threads take the next
+ * unsolved problem as soon as they are done (dynamic schedule), such that
+ * problems with different convergence times are balanced. All memory is
+ * allocated per thread before the solves start. The sparsity pattern of A is
+ * shared by all threads. Every problem starts from 0, the results do not
+ * depend on the number of threads.
+ */
+
+void mexFunction(
+        int nlhs,       mxArray *plhs[],
+        int nrhs, const mxArray *prhs[]
+        )
+{
+    double *F, *CB, *B, *G, *S = NULL;
+    double *U, *C, *J, *DU, *DC;
+    mwSize n, K, nnz = 0;
+    mwSignedIndex k;
+    int t, nt = 1;
+
+    inpaintop *op;
+    pdhgws *ws;
+    double **work;
+    pdhgpar par;
+
+    if (nrhs < 11) {
+        mexErrMsgTxt("Not enough input arguments.");
+    }
+    if (nlhs > 5) {
+        mexErrMsgTxt("Incorrect number of outputs.");
+    }
+
+    n = mxGetM(prhs[0]);
+    K = mxGetN(prhs[0]);
+    if ((n < 1) || (K < 1)) {
+        mexErrMsgTxt("F must not be empty.");
+    }
+    if ((mxGetM(prhs[1]) != n) || (mxGetN(prhs[1]) != K) ||
+            (mxGetM(prhs[4]) != n) || (mxGetN(prhs[4]) != K) ||
+            (mxGetM(prhs[5]) != n) || (mxGetN(prhs[5]) != K)) {
+        mexErrMsgTxt("F, CBAR, B and G must have the same size.");
+    }
+
+    F  = mxGetPr(prhs[0]);
+    CB = mxGetPr(prhs[1]);
+    B  = mxGetPr(prhs[4]);
+    G  = mxGetPr(prhs[5]);
+
+    pdhg_args(&par, nrhs - 6, prhs + 6);
+    if (par.prec != PDHG_DOUBLE) {
+        mexErrMsgTxt("Only double precision is supported in batch mode.");
+    }
+
+    if (mxIsSparse(prhs[2])) {
+        if ((mxGetM(prhs[2]) != n) || (mxGetN(prhs[2]) != n)) {
+            mexErrMsgTxt("A must be square and match the size of f.");
+        }
+        nnz = mxGetJc(prhs[2])[n];
+        if (!mxIsEmpty(prhs[3])) {
+            if ((mxGetM(prhs[3]) != nnz) || (mxGetN(prhs[3]) != K) || mxIsSparse(prhs[3])) {
+                mexErrMsgTxt("S must be a full nnz(A) x K matrix.");
+            }
+            S = mxGetPr(prhs[3]);
+        }
+    }
+
+#ifdef _OPENMP
+    nt = omp_get_max_threads();
+#endif
+    if ((mwSize) nt > K) { nt = (int) K; }
+
+    /* Workspaces of the threads. The operator of a thread is set up with the
+     * data of the first problem and then pointed to the data of the problem at
+     * hand. */
+    op   = mxCalloc(nt, sizeof(inpaintop));
+    ws   = mxCalloc(nt, sizeof(pdhgws));
+    work = mxCalloc(nt, sizeof(double *));
+    for (t = 0; t < nt; t++) {
+        inpaintop_init(&op[t], prhs[2], prhs[3], CB, n);
+        pdhg_alloc(&ws[t], n);
+        work[t] = mxCalloc(OPNORM_WORK(n, PDHG_NRMIT), sizeof(double));
+    }
+
+    plhs[0] = mxCreateDoubleMatrix(n, K, mxREAL);
+    plhs[1] = mxCreateDoubleMatrix(n, K, mxREAL);
+    plhs[2] = mxCreateDoubleMatrix(1, K, mxREAL);
+    plhs[3] = mxCreateDoubleMatrix(1, K, mxREAL);
+    plhs[4] = mxCreateDoubleMatrix(1, K, mxREAL);
+    U  = mxGetPr(plhs[0]);
+    C  = mxGetPr(plhs[1]);
+    J  = mxGetPr(plhs[2]);
+    DU = mxGetPr(plhs[3]);
+    DC = mxGetPr(plhs[4]);
+
+    /* The loops inside the solver are nested parallel regions. They run on
+     * the calling thread only, unless nested parallelism is enabled. */
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(nt) if(nt > 1)
+    for (k = 0; k < (mwSignedIndex) K; k++) {
+        int ii, nlow, tid = 0;
+        double du, dc;
+        mwSize off = (mwSize) k*n;
+
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        if (op[tid].type == INPAINTOP_SPARSE) {
+            if (S) { op[tid].s = S + (mwSize) k*nnz; }
+        } else {
+            op[tid].c = CB + off;
+        }
+
+        pdhg_reset(&ws[tid]);
+        pdhg_norm(&ws[tid], &op[tid], B + off, PDHG_NRMIT, PDHG_NRMTOL, 0, work[tid]);
+        ii = pdhg_solve(&ws[tid], &op[tid], F + off, CB + off, B + off, G + off,
+                &par, &du, &dc, &nlow);
+
+        memcpy(U + off, ws[tid].u, n*sizeof(double));
+        memcpy(C + off, ws[tid].c, n*sizeof(double));
+        J[k]  = ii;
+        DU[k] = du;
+        DC[k] = dc;
+    }
+
+    for (t = 0; t < nt; t++) {
+        mxFree(work[t]);
+        pdhg_free(&ws[t]);
+        inpaintop_free(&op[t]);
+    }
+    mxFree(work);
+    mxFree(ws);
+    mxFree(op);
+}
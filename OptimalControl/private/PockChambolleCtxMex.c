@@ -0,0 +1,183 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "mex.h"
+#include "matrix.h"
+#include "pdhg.h"
+
+/* compile with -largeArrayDims flag. Add -fopenmp to CFLAGS and LDFLAGS to run
+ * the iterations on multiple threads.
+ */
+
+/* Persistent solver contexts for PockChambolleMex.
+ *
+ * A context keeps the workspace of the solver alive between calls. Every solve
+ * starts from the iterates u, c and y of the previous solve. The Lanczos
+ * method for the norm of [A B] starts from the Ritz vector of the previous
+ * solve and typically needs only a few steps. This pays off when a sequence
+ * of slowly changing problems is solved, e.g. in the outer iterations of
+ * FindMask.
+ *
+ * Signature:
+ * h = PCC('new',n)
+ *      Creates a context for problems with n unknowns.
+ * [u c j du dc k jl] = PCC('solve',h,f,cbar,A,[],B,g,eps,mu,lambda,L,tol,...)
+ * [u c j du dc k jl] = PCC('solve',h,f,cbar,[n1 n2],'laplace',B,g,eps,mu,lambda,L,tol,...)
+ *      Same as PockChambolleMex. k is the number of products with [A B] and
+ *      its transpose that were used to estimate the norm of [A B]. The
+ *      iterates are kept in double precision between the calls.
+ * PCC('reset',h)
+ *      Restarts the next solve from 0.
+ * PCC('delete',h)
+ *      Frees the context.
+ */
+
+/* Maximal number of contexts alive at the same time. */
+#define PDHGCTX_MAX 64
+
+static pdhgws *ctx[PDHGCTX_MAX];
+static int nctx = 0;
+
+static void ctx_destroy(
+        int h)
+{
+    pdhg_free(ctx[h]);
+    mxFree(ctx[h]);
+    ctx[h] = NULL;
+    if (--nctx == 0) { mexUnlock(); }
+}
+
+static void ctx_cleanup(void)
+{
+    int h;
+    for (h = 0; h < PDHGCTX_MAX; h++) {
+        if (ctx[h]) { ctx_destroy(h); }
+    }
+}
+
+/* Returns the context index for the handle prhs. */
+static int ctx_get(
+        const mxArray *prhs)
+{
+    double h = mxGetScalar(prhs);
+    if ((h < 1) || (h > PDHGCTX_MAX) || (h != floor(h)) || !ctx[(int) h - 1]) {
+        mexErrMsgTxt("Invalid solver handle.");
+    }
+    return (int) h - 1;
+}
+
+void mexFunction(
+        int nlhs,       mxArray *plhs[],
+        int nrhs, const mxArray *prhs[]
+        )
+{
+    char cmd[8];
+    int h;
+
+    if ((nrhs < 2) || !mxIsChar(prhs[0]) || mxGetString(prhs[0], cmd, sizeof(cmd))) {
+        mexErrMsgTxt("Expected a command ('new', 'solve', 'reset' or 'delete') and a handle.");
+    }
+
+    if (!strcmp(cmd, "new")) {
+        mwSize n = (mwSize) mxGetScalar(prhs[1]);
+
+        for (h = 0; (h < PDHGCTX_MAX) && ctx[h]; h++) { }
+        if (h == PDHGCTX_MAX) {
+            mexErrMsgTxt("Too many solver contexts. Delete unused ones first.");
+        }
+        if (n < 1) {
+            mexErrMsgTxt("The number of unknowns must be positive.");
+        }
+
+        ctx[h] = mxMalloc(sizeof(pdhgws));
+        pdhg_alloc(ctx[h], n);
+        mexMakeMemoryPersistent(ctx[h]);
+        pdhg_persistent(ctx[h]);
+
+        if (nctx++ == 0) {
+            mexLock();
+            mexAtExit(ctx_cleanup);
+        }
+        plhs[0] = mxCreateDoubleScalar(h+1);
+
+    } else if (!strcmp(cmd, "reset")) {
+        pdhg_reset(ctx[ctx_get(prhs[1])]);
+
+    } else if (!strcmp(cmd, "delete")) {
+        ctx_destroy(ctx_get(prhs[1]));
+
+    } else if (!strcmp(cmd, "solve")) {
+        /* The arguments are those of PockChambolleMex, shifted by two. */
+        const mxArray **arg = prhs + 2;
+        double *f, *cb, *b, *g;
+        double du, dc;
+        int ii, k, nlow;
+        mwSignedIndex jj;
+
+        inpaintop op;
+        pdhgpar par;
+        pdhgws *ws;
+
+        if (nrhs < 13) {
+            mexErrMsgTxt("Not enough input arguments.");
+        }
+        ws = ctx[ctx_get(prhs[1])];
+        if (mxGetNumberOfElements(arg[0]) != ws->n) {
+            mexErrMsgTxt("The size of f does not match the solver context.");
+        }
+
+        f      = mxGetPr(arg[0]);
+        cb     = mxGetPr(arg[1]);
+
+        inpaintop_init(&op, arg[2], arg[3], cb, ws->n);
+
+        b      = mxGetPr(arg[4]);
+        g      = mxGetPr(arg[5]);
+
+        pdhg_args(&par, nrhs - 8, arg + 6);
+
+        /* Refine the norm estimate of the previous solve. */
+        k  = pdhg_norm(ws, &op, b, PDHG_NRMIT, PDHG_NRMTOL, 1, NULL);
+
+        ii = pdhg_solve(ws, &op, f, cb, b, g, &par, &du, &dc, &nlow);
+
+        /* Create Output. */
+        double *ur, *cr;
+        plhs[0] = mxCreateDoubleMatrix(ws->n,  1, mxREAL);
+        plhs[1] = mxCreateDoubleMatrix(ws->n,  1, mxREAL);
+        ur = mxGetData(plhs[0]);
+        cr = mxGetData(plhs[1]);
+        plhs[2] = mxCreateDoubleScalar(ii);
+        plhs[3] = mxCreateDoubleScalar(du);
+        plhs[4] = mxCreateDoubleScalar(dc);
+        if (nlhs > 5) { plhs[5] = mxCreateDoubleScalar(k); }
+        if (nlhs > 6) { plhs[6] = mxCreateDoubleScalar(nlow); }
+
+        for( jj = 0; jj < (mwSignedIndex) ws->n; jj++ ){
+            ur[jj] = ws->u[jj];
+            cr[jj] = ws->c[jj];
+        }
+
+        inpaintop_free(&op);
+
+    } else {
+        mexErrMsgTxt("Unknown command. Use 'new', 'solve', 'reset' or 'delete'.");
+    }
+}
@@ -20,43 +20,27 @@
 #include <stdlib.h>
 #include "mex.h"
 #include "matrix.h"
+#include "pdhg.h"
 
-double sgn(double x)
-{
-    if (x>0) { return 1.0; }
-    else { return -1.0; }
-    return 0.0;
-}
-
-double max0(double x)
-{
-    if (x > 0.0) { return x; }
-    else { return 0.0; }
-}
-
-void smvp(
-        mwIndex *ir,
-        mwIndex *jc,
-        double *s,
-        double *b,
-        double *x,
-        mwSize ncol)
-{
-    int i, k;
-    for (i=0; i<ncol; i++) {
-        int stop = jc[i+1];
-        double rhs = b[i];
-        for (k=jc[i]; k<stop; k++) {
-            x[ir[k]] += s[k] * rhs;
-        }
-    }
-    return;
-}
-
-/* compile with -largeArrayDims flag */
+/* compile with -largeArrayDims flag. Add -fopenmp to CFLAGS and LDFLAGS to run
+ * the iterations on multiple threads. The stopping distances, the residual of
+ * the low precision refresh and the inner products of the Lanczos estimate of
+ * the operator norm (see pdhg_norm and opnorm.h) are then summed per thread,
+ * so the results are only unchanged up to rounding.
+ */
 
 /* Signature:
- * [u c j du dc] = PC(f,cbar,A,A',B,g,eps,mu,lambda,L,tol,gamma)
+ * [u c j du dc jl] = PC(f,cbar,A,[],B,g,eps,mu,lambda,L,tol,gamma,alpha,prec,polish,reg,kappa)
+ *
+ * A' is not required. For compatibility, the legacy call with A' as fourth
+ * argument is still accepted, the argument is ignored.
+ *
+ * Matrix free mode, A is applied from cbar on the fly (see inpaintop.h):
+ * [u c j du dc jl] = PC(f,cbar,[n1 n2],'laplace',B,g,eps,mu,lambda,L,tol,...)
+ * [u c j du dc jl] = PC(f,cbar,[n1 n2],'biharmonic',B,g,eps,mu,lambda,L,tol,...)
+ *
+ * jl is the number of iterations that were carried out in single or mixed
+ * precision, see prec.
  */
 
 void mexFunction(
@@ -67,230 +51,95 @@ void mexFunction(
     /*
      * f      = signal.
      * cb     = cbar (old mask).
-     * A      = inpainting mask.
-     * At     = transpose of inpainting mask.
+     * A      = inpainting mask (or grid size [n1 n2] in matrix free mode).
+     * op     = unused (or name of the operator in matrix free mode).
      * b      = diagonal entries of the matrix B.
      * g      = RHS of my linearisation.
      * eps    = epsilon from energy (regularisation term).
      * mu     = mu from energy (proximal term).
      * lambda = lambda from energy (sparsity term).
-     * gamma  = factor for convergence acceleration. (not implemented)
+     * L      = maximal number of iterations.
+     * tol    = stopping tolerance on the change of the iterates.
+     * gamma  = strong convexity modulus of the primal energy (optional). If
+     *          gamma > 0 the accelerated variant (Algorithm 2 in Chambolle and
+     *          Pock, 2011) with decreasing tau and increasing sigma is used.
+     *          gamma must not exceed min(1,eps+mu+m), where m is lambda for
+     *          'l2', lambda*kappa for 'elasticnet' and 0 otherwise. The
+     *          default 0 keeps the step sizes fixed.
+     * alpha  = initial adaptivity level of the step sizes (optional). If
+     *          alpha > 0, tau and sigma are balanced such that the primal and
+     *          dual residuals stay within a factor 1.5 of each other (Goldstein
+     *          et al., Adaptive Primal-Dual Hybrid Gradient Methods, 2013). The
+     *          level decays by 0.95 with every change. 0.5 is a good choice.
+     *          The default 0 keeps the step sizes fixed.
+     * prec   = precision of the iterations (optional), 'double' (default),
+     *          'single' or 'mixed'. 'single' stores the iterates and the data
+     *          of A in float and computes in float, 'mixed' stores in float
+     *          and computes in double. The progress is checked in double
+     *          precision every PDHG_REFRESH iterations, see pdhg.h.
+     * polish = if not 0 (default 1), a single or mixed precision solve is
+     *          finished with double precision iterations.
+     * reg    = regulariser of the mask (optional), 'l1' (default), 'l2',
+     *          'elasticnet', 'box' or 'huber', see pdhg.h.
+     * kappa  = parameter of the regulariser (optional, default 1).
      */
     
-    double *f, *cb, *A, *At, *b, *g;
-    double eps, mu, lambda, L, tol, gamma;
-    
-    mwIndex *Air, *Ajc, *Atir, *Atjc;
+    double *f, *cb, *b, *g;
+    double du, dc;                          /* distance between the iterates. */
+    int ii, nlow;
     
-    /* Get size of matrix A. */
-    mwSize Anrow  = mxGetM(prhs[2]);
-    mwSize Ancol  = mxGetN(prhs[2]);
+    inpaintop op;
+    pdhgpar par;
     
-    /* Get size of matrix A'. */
-    mwSize Atnrow = mxGetM(prhs[3]);
-    mwSize Atncol = mxGetN(prhs[3]);
+    if (nrhs < 11) {
+        mexErrMsgTxt("Not enough input arguments.");
+    }
     
-    /* Note that the Matrix A is square. The above dimensions should all be the
-     * same.
-     */
+    /* Number of unknowns. Note that the Matrix A is square. */
+    mwSize Anrow  = mxGetNumberOfElements(prhs[0]);
     
     /* Get input data. */
     f      = mxGetPr(prhs[0]);
     cb     = mxGetPr(prhs[1]);
     
-    A      = mxGetPr(prhs[2]);
-    Air    = mxGetIr(prhs[2]);
-    Ajc    = mxGetJc(prhs[2]);
-    
-    At     = mxGetPr(prhs[3]);
-    Atir   = mxGetIr(prhs[3]);
-    Atjc   = mxGetJc(prhs[3]);
+    inpaintop_init(&op, prhs[2], prhs[3], cb, Anrow);
     
     b      = mxGetPr(prhs[4]);
     g      = mxGetPr(prhs[5]);
     
-    eps    = mxGetScalar(prhs[6]);
-    mu     = mxGetScalar(prhs[7]);
-    lambda = mxGetScalar(prhs[8]);
-    L      = mxGetScalar(prhs[9]);
-    tol    = mxGetScalar(prhs[10]);
-    /* gamma  = mxGetScalar(prhs[11]); */
+    pdhg_args(&par, nrhs - 6, prhs + 6);
     
-    int ii,jj;
+    mwSignedIndex jj, N = (mwSignedIndex) Anrow;
     
-    /* Variables used in the iterations.
-     * u     = current solution.
-     * ub    = extrapolated solution.
-     * uold  = old solution.
-     * c     = current mask.
-     * cba   = extrapolated mask.
-     * cold  = old mask.
-     * temp1 = temp variable to store data.
-     * temp2 = temp variable to store data.
-     * y     = internal var used by the algorithm.
+    /* Variables used in the iterations, see pdhg.h. The old iterates and the
+     * matrix vector products are never stored. Each half step of the
+     * algorithm is a single sweep over the data.
      */
-    double *u, *c, *ub, *uold, *cba, *cold, *temp1, *temp2, *y;
-    u     = mxCalloc(Anrow,  sizeof(double));
-    ub    = mxCalloc(Anrow,  sizeof(double));
-    uold  = mxCalloc(Anrow,  sizeof(double));
+    pdhgws ws;
+    pdhg_alloc(&ws, Anrow);
     
-    c     = mxCalloc(Anrow,  sizeof(double));
-    cba   = mxCalloc(Anrow,  sizeof(double));
-    cold  = mxCalloc(Anrow,  sizeof(double));
+    /* Lanczos method to get a bound for the norm of [A B]. */
+    pdhg_norm(&ws, &op, b, PDHG_NRMIT, PDHG_NRMTOL, 0, NULL);
     
-    y     = mxCalloc(Anrow,  sizeof(double));
-    temp1 = mxCalloc(Anrow,  sizeof(double));
-    temp2 = mxCalloc(Atnrow, sizeof(double));
-    
-    double du, dc;                          /* distance between the iterates. */
-    
-    /* Perform power method to get estimate of the largest eigenvalue of A. */
-    double *EVO, *EV, *EVtemp;
-    
-    EVO    = mxCalloc(Anrow, sizeof(double));
-    EV     = mxCalloc(Anrow, sizeof(double));
-    EVtemp = mxCalloc(Anrow, sizeof(double));
-    
-    double lam, norm;
-    
-    /* Initialise vector with 1. */
-    for ( ii = 0; ii < Anrow; ii++ ) { EVO[ii] = 1.0; }
-    /* Iterate to get estimate for largest eigenvalue of A */
-    for ( ii = 0; ii < 50; ii++ )
-    {
-        /* EV = A*EVO */
-        smvp( Air, Ajc, A, EVO, EV, Ancol);
-        /* EVtemp = A*EV */
-        smvp( Air, Ajc, A, EV, EVtemp, Ancol);
-        
-        lam = 0.0;                                 /* <EV,EVtemp> = <EV,A*EV> */
-        norm = 0.0;                                /* <EV,EV> */
-        for( jj = 0; jj < Anrow ; jj++ ){
-            lam   += EV[jj]*EVtemp[jj];
-            norm  += EV[jj]*EV[jj];
-        }
-        
-        lam = lam/norm;
-        norm = sqrt(norm);
-        
-        /* Normalise current estimate for the eigenvector
-         * and reset temp vars.
-         */
-        for ( jj = 0; jj < Anrow; jj++ )
-        {
-            EVO[jj] = EV[jj]/norm;
-            EV[jj] = 0.0;
-            EVtemp[jj] = 0.0;
-        }
-    }
-    
-    /* Get largest Eigenvalue of B */
-    double temp = b[0]*b[0];
-    for ( ii = 0; ii < Anrow; ii++ ) {
-        if( b[ii]*b[ii] > temp ){ temp = b[ii]*b[ii]; }
-    }
-    
-    /* Add Eigenvalues to get estimate for squared operator norm. */
-    lam = lam*lam + temp;
-    
-    /* Set step sizes */
-    double tau = 0.25;
-    double sigma = 1.0/((lam+0.1)*tau);
-    double theta = 1.0;
-    
-    double dummy = 1.0/(1.0+tau*eps+tau*mu);                    /* Time saver */
-    
-    for ( ii = 0; ii < L; ii++ )
-    {
-        
-        /* temp1 = A*ub */
-        smvp( Air, Ajc, A, ub, temp1, Ancol );
-        
-        for ( jj = 0; jj < Anrow; jj++ )
-        {    
-            /* Update y:
-             * y = y + sigma * ( A*ub + b*cb - g )
-             */
-            y[jj] = y[jj] + sigma * (temp1[jj] + b[jj] * cba[jj] - g[jj]);
-            temp1[jj] = 0.0;
-            
-            /* Save variables u and c inside uold and cold:
-             * uold = u
-             * cold = c
-             */
-            uold[jj] = u[jj];
-            cold[jj] = c[jj];
-        }
-        
-        /* temp2 = A'*y */
-        smvp( Atir, Atjc, At, y, temp2, Atncol);
-        
-        for ( jj = 0; jj < Anrow; jj++ )
-        {
-            /* Update u:
-             * u = 1/(1+tau) * ( u - tau*( A'*y - f) )
-             */
-            u[jj] = 1.0/(1.0+tau) * (u[jj] - tau*(temp2[jj] - f[jj]));
-            /* Update c:
-             * c = shrink( (c - tau*B*y + tau*mu*cb)/(1+tau*eps+tau*mu) , tau*lambda/(1+tau*eps+tau*mu) );
-             */
-            c[jj] =         sgn( c[jj] - tau*b[jj]*y[jj] + tau*mu*cb[jj] ) *
-                    max0( (fabs( c[jj] - tau*b[jj]*y[jj] + tau*mu*cb[jj] ) - tau*lambda) * dummy);
-            
-            /* Update ub and cba:
-             * ub = u + theta*(u-uold);
-             * cb = c + theta*(c-cold);
-             */
-            ub[jj]    = u[jj] + theta*(u[jj]-uold[jj]);
-            cba[jj]   = c[jj] + theta*(c[jj]-cold[jj]);
-            temp2[jj] = 0.0;
-        }
-        
-        /* Compute squared norm between to iterates. */
-        du = 0.0;
-        dc = 0.0;
-        for (jj = 0; jj < Anrow; jj++ )
-        {
-            du += (u[jj]-uold[jj])*(u[jj]-uold[jj]);
-            dc += (c[jj]-cold[jj])*(c[jj]-cold[jj]);
-        }
-        du = sqrt(du);
-        dc = sqrt(dc);
-        
-        /* Stop if change has become small enough */
-        if ((ii > 1) && (du < tol) && (dc < tol)) {
-            break;
-        }
-    }
+    ii = pdhg_solve(&ws, &op, f, cb, b, g, &par, &du, &dc, &nlow);
     
     /* Create Output. */
     double *ur, *cr;
     plhs[0] = mxCreateDoubleMatrix(Anrow,  1, mxREAL);
-    plhs[1] = mxCreateDoubleMatrix(Atnrow, 1, mxREAL);
+    plhs[1] = mxCreateDoubleMatrix(Anrow,  1, mxREAL);
     ur = mxGetData(plhs[0]);
     cr = mxGetData(plhs[1]);
     plhs[2] = mxCreateDoubleScalar(ii);
     plhs[3] = mxCreateDoubleScalar(du);
     plhs[4] = mxCreateDoubleScalar(dc);
+    if (nlhs > 5) { plhs[5] = mxCreateDoubleScalar(nlow); }
     
-    for( jj = 0; jj < Anrow; jj++ ){
-        ur[jj] = u[jj];
-        cr[jj] = c[jj];
+    for( jj = 0; jj < N; jj++ ){
+        ur[jj] = ws.u[jj];
+        cr[jj] = ws.c[jj];
     }
     
     /* Free space. */
-    mxFree(temp1);
-    mxFree(temp2);
-    mxFree(y);
-    mxFree(c);
-    mxFree(cba);
-    mxFree(cold);
-    mxFree(u);
-    mxFree(ub);
-    mxFree(uold);
-    mxFree(EVO);
-    mxFree(EV);
-    mxFree(EVtemp);
-    
-    return;
+    pdhg_free(&ws);
+    inpaintop_free(&op);
 }
@@ -0,0 +1,295 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INPAINTOP_H
+#define INPAINTOP_H
+
+#include <string.h>
+#ifdef MATLAB_MEX_FILE
+#include "mex.h"
+#include "matrix.h"
+#else
+#include "nomex.h"
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* The matrix A = C - (I-C)*D of the linearised inpainting problem, with
+ * C = diag(cbar).
+ *
+ * A is either passed explicitly as a sparse CSC matrix (INPAINTOP_SPARSE), or
+ * it is applied on the fly from the mask cbar on an n1 x n2 grid. In the latter
+ * case D is the 5-point Laplacian with Neumann boundary conditions
+ * (INPAINTOP_LAPLACE) or -D*D (INPAINTOP_BIHARMONIC). The grid is labeled
+ * column wise, e.g. the first dimension runs fastest in memory, so that D
+ * coincides with LaplaceM(n1,n2) and -LaplaceM(n1,n2)^2 respectively.
+ *
+ * The products are evaluated entry wise by inpaintop_row and inpaintop_rowt.
+ * Each entry is gathered by a single thread, so that the products can be
+ * parallelised without any synchronisation. Some products need an additional
+ * sweep over the data beforehand, which is done by inpaintop_prepare.
+ *
+ * A sparse A is never transposed. A'*x is gathered column wise from the CSC
+ * arrays. A*x is scattered column wise: each thread handles a block of columns
+ * with a similar number of non-zeros and accumulates into a private buffer that
+ * spans only the rows touched by its block. For the banded matrices occuring
+ * here, the buffers together are hardly larger than x. The buffers are then
+ * summed row wise.
+ */
+
+enum { INPAINTOP_SPARSE, INPAINTOP_LAPLACE, INPAINTOP_BIHARMONIC };
+
+typedef struct {
+    int type;            /* One of the INPAINTOP_* constants.               */
+    mwSignedIndex n;     /* Number of unknowns.                             */
+
+    mwIndex *ir, *jc;    /* CSC arrays of A (INPAINTOP_SPARSE only).        */
+    double  *s;
+    int      nblk;       /* Number of column blocks for A*x.                */
+    mwIndex *blk;        /* Column block t is [blk[t], blk[t+1]).           */
+    mwIndex *rlo, *rhi;  /* Rows touched by block t are [rlo[t], rhi[t]).   */
+    mwIndex *off;        /* Offset of the buffer of block t in buf.         */
+    double  *buf;        /* Private buffers of all blocks.                  */
+    mwIndex  lbuf;       /* Length of buf.                                  */
+
+    mwSignedIndex n1;    /* Grid size (matrix free operators only).         */
+    mwSignedIndex n2;
+    double *c;           /* Mask cbar (matrix free operators only).         */
+
+    double *w;           /* Work array (INPAINTOP_SPARSE and _BIHARMONIC).  */
+
+    float *sf, *cf, *wf; /* Float copies of s and c, float work array and   */
+    float *buff;         /* buffers, see inpaintop_lowprec.                 */
+} inpaintop;
+
+/* The products are instantiated for three precisions:
+ *
+ * double         double vectors and arithmetic (inpaintop_row, ...).
+ * single         float vectors and arithmetic (inpaintop_row_s, ...).
+ * mixed          float vectors and double arithmetic (inpaintop_row_m, ...).
+ *
+ * The float versions use the copies of the data of A that are created by
+ * inpaintop_lowprec.
+ */
+#define IPT_REAL    double
+#define IPT_ACC     double
+#define IPT_ONE     1.0
+#define IPT_NAME(f) f
+#define IPT_S(op)   ((op)->s)
+#define IPT_C(op)   ((op)->c)
+#define IPT_W(op)   ((op)->w)
+#define IPT_BUF(op) ((op)->buf)
+#include "inpaintop_t.h"
+
+#define IPT_REAL    float
+#define IPT_ACC     float
+#define IPT_ONE     1.0f
+#define IPT_NAME(f) f##_s
+#define IPT_S(op)   ((op)->sf)
+#define IPT_C(op)   ((op)->cf)
+#define IPT_W(op)   ((op)->wf)
+#define IPT_BUF(op) ((op)->buff)
+#include "inpaintop_t.h"
+
+#define IPT_REAL    float
+#define IPT_ACC     double
+#define IPT_ONE     1.0
+#define IPT_NAME(f) f##_m
+#define IPT_S(op)   ((op)->sf)
+#define IPT_C(op)   ((op)->cf)
+#define IPT_W(op)   ((op)->wf)
+#define IPT_BUF(op) ((op)->buf)
+#include "inpaintop_t.h"
+
+/* Splits the columns of a sparse A into blocks with a similar number of
+ * non-zeros and determines the rows touched by each block.
+ */
+static inline void csc_blocks(
+        inpaintop *op)
+{
+    int t, nblk = 1;
+    mwIndex j, l, nnz, len;
+
+#ifdef _OPENMP
+    nblk = omp_get_max_threads();
+#endif
+    if ((mwSignedIndex) nblk > op->n) { nblk = (int) op->n; }
+    if (nblk < 1) { nblk = 1; }
+
+    op->nblk = nblk;
+    op->blk  = mxCalloc(nblk+1, sizeof(mwIndex));
+    op->rlo  = mxCalloc(nblk,   sizeof(mwIndex));
+    op->rhi  = mxCalloc(nblk,   sizeof(mwIndex));
+    op->off  = mxCalloc(nblk,   sizeof(mwIndex));
+
+    nnz = op->jc[op->n];
+    j = 0;
+    for (t = 0; t < nblk; t++) {
+        op->blk[t] = j;
+        while (((mwSignedIndex) j < op->n) && (op->jc[j] < (nnz/nblk)*(t+1))) { j++; }
+    }
+    op->blk[nblk] = (mwIndex) op->n;
+
+    len = 0;
+    for (t = 0; t < nblk; t++) {
+        op->rlo[t] = (mwIndex) op->n;
+        op->rhi[t] = 0;
+        for (l = op->jc[op->blk[t]]; l < op->jc[op->blk[t+1]]; l++) {
+            if (op->ir[l] <  op->rlo[t]) { op->rlo[t] = op->ir[l]; }
+            if (op->ir[l] >= op->rhi[t]) { op->rhi[t] = op->ir[l]+1; }
+        }
+        if (op->rhi[t] < op->rlo[t]) { op->rlo[t] = op->rhi[t] = 0; }
+        op->off[t] = len;
+        len += op->rhi[t] - op->rlo[t];
+    }
+    op->lbuf = len > 0 ? len : 1;
+    op->buf  = mxCalloc(op->lbuf, sizeof(double));
+}
+
+/* Sets up the matrix free operator of the given type (INPAINTOP_LAPLACE or
+ * INPAINTOP_BIHARMONIC) on an n1 x n2 grid with the mask cbar. cbar is not
+ * copied and may be changed between the products.
+ */
+static inline void inpaintop_grid(
+        inpaintop *op,
+        int type,
+        mwSignedIndex n1,
+        mwSignedIndex n2,
+        double *cbar)
+{
+    memset(op, 0, sizeof(inpaintop));
+    if ((n1 < 1) || (n2 < 1)) {
+        mexErrMsgTxt("The grid size does not match the size of f.");
+    }
+
+    op->type = type;
+    op->n    = n1*n2;
+    op->n1   = n1;
+    op->n2   = n2;
+    op->c    = cbar;
+
+    if (type == INPAINTOP_BIHARMONIC) {
+        op->w = mxCalloc(op->n, sizeof(double));
+    } else if (type != INPAINTOP_LAPLACE) {
+        mexErrMsgTxt("Unknown operator. Use 'laplace' or 'biharmonic'.");
+    }
+}
+
+#ifdef MATLAB_MEX_FILE
+/* Sets up the operator from the MEX arguments A and op. The mask cbar must
+ * contain n entries.
+ *
+ * Sparse mode: A is the sparse matrix A. The argument name is ignored. It is
+ *              accepted for compatibility with callers that still pass A'.
+ * Matrix free: A is the grid size [n1 n2] and name the name of the operator,
+ *              either 'laplace' or 'biharmonic'.
+ */
+static inline void inpaintop_init(
+        inpaintop *op,
+        const mxArray *A,
+        const mxArray *opname,
+        double *cbar,
+        mwSize n)
+{
+    char name[16];
+    double *dims;
+    int type = -1;
+
+    if (mxIsSparse(A)) {
+        if ((mxGetM(A) != n) || (mxGetN(A) != n)) {
+            mexErrMsgTxt("A must be square and match the size of f.");
+        }
+        memset(op, 0, sizeof(inpaintop));
+        op->n    = (mwSignedIndex) n;
+        op->type = INPAINTOP_SPARSE;
+        op->s    = mxGetPr(A);
+        op->ir   = mxGetIr(A);
+        op->jc   = mxGetJc(A);
+        op->w    = mxCalloc(n, sizeof(double));
+        csc_blocks(op);
+        return;
+    }
+
+    if (mxGetNumberOfElements(A) != 2 || !mxIsDouble(A)) {
+        mexErrMsgTxt("A must be a sparse matrix or the grid size [n1 n2].");
+    }
+    if (!mxIsChar(opname) || mxGetString(opname, name, sizeof(name))) {
+        mexErrMsgTxt("Expected the name of the operator ('laplace' or 'biharmonic').");
+    }
+
+    dims = mxGetPr(A);
+    if ((mwSignedIndex) dims[0]*(mwSignedIndex) dims[1] != (mwSignedIndex) n) {
+        mexErrMsgTxt("The grid size does not match the size of f.");
+    }
+
+    if (!strcmp(name, "laplace")) {
+        type = INPAINTOP_LAPLACE;
+    } else if (!strcmp(name, "biharmonic")) {
+        type = INPAINTOP_BIHARMONIC;
+    }
+    inpaintop_grid(op, type, (mwSignedIndex) dims[0], (mwSignedIndex) dims[1], cbar);
+}
+#endif /* MATLAB_MEX_FILE */
+
+/* Creates the float copies of the data of A and the float work arrays that are
+ * needed by the single and mixed precision products. Must be called again
+ * whenever cbar has changed.
+ */
+static inline void inpaintop_lowprec(
+        inpaintop *op)
+{
+    mwSignedIndex k;
+
+    if (op->type == INPAINTOP_SPARSE) {
+        mwIndex nnz = op->jc[op->n];
+        if (!op->sf) {
+            op->sf   = mxCalloc(nnz > 0 ? nnz : 1, sizeof(float));
+            op->buff = mxCalloc(op->lbuf, sizeof(float));
+        }
+        #pragma omp parallel for schedule(static)
+        for (k = 0; k < (mwSignedIndex) nnz; k++) { op->sf[k] = (float) op->s[k]; }
+    } else {
+        if (!op->cf) { op->cf = mxCalloc(op->n, sizeof(float)); }
+        #pragma omp parallel for schedule(static)
+        for (k = 0; k < op->n; k++) { op->cf[k] = (float) op->c[k]; }
+    }
+    if (op->w && !op->wf) { op->wf = mxCalloc(op->n, sizeof(float)); }
+}
+
+/* Frees the memory allocated by inpaintop_init and inpaintop_lowprec. */
+static inline void inpaintop_free(
+        inpaintop *op)
+{
+    if (op->w)    { mxFree(op->w); }
+    if (op->blk)  { mxFree(op->blk); mxFree(op->rlo); mxFree(op->rhi); mxFree(op->off); }
+    if (op->buf)  { mxFree(op->buf); }
+    if (op->sf)   { mxFree(op->sf); }
+    if (op->cf)   { mxFree(op->cf); }
+    if (op->wf)   { mxFree(op->wf); }
+    if (op->buff) { mxFree(op->buff); }
+    op->w    = NULL;
+    op->blk  = NULL;
+    op->buf  = NULL;
+    op->sf   = NULL;
+    op->cf   = NULL;
+    op->wf   = NULL;
+    op->buff = NULL;
+}
+
+#endif /* INPAINTOP_H */
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Products with the operator A of inpaintop.h for one floating point type.
+ *
+ * This file is included by inpaintop.h once for every precision, with the
+ * following macros defined:
+ *
+ * IPT_REAL     type of the vectors and of the copies of the data of A.
+ * IPT_ACC      type used for the arithmetic.
+ * IPT_ONE      1 as IPT_ACC.
+ * IPT_NAME(f)  name of the function f in this precision.
+ * IPT_S(op)    values of a sparse A as IPT_REAL.
+ * IPT_C(op)    mask cbar as IPT_REAL.
+ * IPT_W(op)    work array as IPT_REAL.
+ * IPT_BUF(op)  buffers of the sparse product as IPT_ACC.
+ *
+ * The macros are undefined at the end of the file.
+ */
+
+/* Returns the inner product of the column col of a CSC matrix with b.
+ *
+ * Since a column of A' is a row of A, this computes one entry of A*b from the
+ * CSC arrays of A' and one entry of A'*b from the CSC arrays of A.
+ */
+static inline IPT_ACC IPT_NAME(coldot)(
+        mwIndex *ir,
+        mwIndex *jc,
+        IPT_REAL *s,
+        const IPT_REAL *b,
+        mwIndex col)
+{
+    mwIndex k;
+    IPT_ACC res = 0;
+    for (k=jc[col]; k<jc[col+1]; k++) {
+        res += (IPT_ACC) s[k] * b[ir[k]];
+    }
+    return res;
+}
+
+/* Returns (D*x)[k] for the 5-point Laplacian with Neumann boundary conditions.
+ * If c is not NULL, D is applied to (1-c).*x instead.
+ */
+static inline IPT_ACC IPT_NAME(laplace5p)(
+        const inpaintop *op,
+        const IPT_REAL *x,
+        const IPT_REAL *c,
+        mwSignedIndex k)
+{
+    mwSignedIndex n1 = op->n1;
+    mwSignedIndex j  = k / n1;
+    mwSignedIndex i  = k - j*n1;
+    IPT_ACC xk = c ? (IPT_ONE-c[k])*x[k] : (IPT_ACC) x[k];
+    IPT_ACC d  = 0;
+
+    if (c) {
+        if (i > 0)          { d += (IPT_ONE-c[k-1]) *x[k-1]  - xk; }
+        if (i < n1-1)       { d += (IPT_ONE-c[k+1]) *x[k+1]  - xk; }
+        if (j > 0)          { d += (IPT_ONE-c[k-n1])*x[k-n1] - xk; }
+        if (j < op->n2-1)   { d += (IPT_ONE-c[k+n1])*x[k+n1] - xk; }
+    } else {
+        if (i > 0)          { d += x[k-1]  - xk; }
+        if (i < n1-1)       { d += x[k+1]  - xk; }
+        if (j > 0)          { d += x[k-n1] - xk; }
+        if (j < op->n2-1)   { d += x[k+n1] - xk; }
+    }
+    return d;
+}
+
+/* Computes w = A*x for a sparse A, see above. */
+static inline void IPT_NAME(csc_mult)(
+        inpaintop *op,
+        const IPT_REAL *x)
+{
+    mwSignedIndex k;
+
+    #pragma omp parallel num_threads(op->nblk)
+    {
+        int t, nthr = 1, tid = 0;
+        mwIndex j, l;
+#ifdef _OPENMP
+        nthr = omp_get_num_threads();
+        tid  = omp_get_thread_num();
+#endif
+        /* Each thread scatters its own blocks. */
+        for (t = tid; t < op->nblk; t += nthr) {
+            IPT_ACC *buf = IPT_BUF(op) + op->off[t];
+            mwIndex rlo = op->rlo[t];
+            for (l = 0; l < op->rhi[t]-rlo; l++) { buf[l] = 0; }
+            for (j = op->blk[t]; j < op->blk[t+1]; j++) {
+                IPT_ACC xj = x[j];
+                for (l = op->jc[j]; l < op->jc[j+1]; l++) {
+                    buf[op->ir[l]-rlo] += IPT_S(op)[l] * xj;
+                }
+            }
+        }
+
+        #pragma omp barrier
+
+        /* Sum up the contributions of all blocks. */
+        #pragma omp for schedule(static)
+        for (k = 0; k < op->n; k++) {
+            IPT_ACC sum = 0;
+            for (t = 0; t < op->nblk; t++) {
+                if ((op->rlo[t] <= (mwIndex) k) && ((mwIndex) k < op->rhi[t])) {
+                    sum += IPT_BUF(op)[op->off[t] + k - op->rlo[t]];
+                }
+            }
+            IPT_W(op)[k] = (IPT_REAL) sum;
+        }
+    }
+}
+
+/* Prepares the evaluation of A*x (transp == 0) or A'*x (transp != 0). Must be
+ * called whenever x has changed and before calling inpaintop_row resp.
+ * inpaintop_rowt. For a sparse A it stores A*x in the work array. For the
+ * biharmonic operator it stores D*x resp. D*((1-c).*x) in the work array.
+ */
+static inline void IPT_NAME(inpaintop_prepare)(
+        inpaintop *op,
+        const IPT_REAL *x,
+        int transp)
+{
+    mwSignedIndex k;
+
+    if ((op->type == INPAINTOP_SPARSE) && !transp) {
+        IPT_NAME(csc_mult)(op, x);
+    }
+
+    if (op->type != INPAINTOP_BIHARMONIC) { return; }
+
+    #pragma omp parallel for schedule(static)
+    for (k = 0; k < op->n; k++) {
+        IPT_W(op)[k] = (IPT_REAL) IPT_NAME(laplace5p)(op, x, transp ? IPT_C(op) : NULL, k);
+    }
+}
+
+/* Returns (A*x)[k]. */
+static inline IPT_ACC IPT_NAME(inpaintop_row)(
+        const inpaintop *op,
+        const IPT_REAL *x,
+        mwSignedIndex k)
+{
+    switch (op->type) {
+        case INPAINTOP_LAPLACE:
+            return (IPT_ACC) IPT_C(op)[k]*x[k] - (IPT_ONE-IPT_C(op)[k])*IPT_NAME(laplace5p)(op, x, NULL, k);
+        case INPAINTOP_BIHARMONIC:
+            return (IPT_ACC) IPT_C(op)[k]*x[k] + (IPT_ONE-IPT_C(op)[k])*IPT_NAME(laplace5p)(op, IPT_W(op), NULL, k);
+        default:
+            return IPT_W(op)[k];
+    }
+}
+
+/* Returns (A'*x)[k]. */
+static inline IPT_ACC IPT_NAME(inpaintop_rowt)(
+        const inpaintop *op,
+        const IPT_REAL *x,
+        mwSignedIndex k)
+{
+    switch (op->type) {
+        case INPAINTOP_LAPLACE:
+            return (IPT_ACC) IPT_C(op)[k]*x[k] - IPT_NAME(laplace5p)(op, x, IPT_C(op), k);
+        case INPAINTOP_BIHARMONIC:
+            return (IPT_ACC) IPT_C(op)[k]*x[k] + IPT_NAME(laplace5p)(op, IPT_W(op), NULL, k);
+        default:
+            return IPT_NAME(coldot)(op->ir, op->jc, IPT_S(op), x, k);
+    }
+}
+
+#undef IPT_REAL
+#undef IPT_ACC
+#undef IPT_ONE
+#undef IPT_NAME
+#undef IPT_S
+#undef IPT_C
+#undef IPT_W
+#undef IPT_BUF
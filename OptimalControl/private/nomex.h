@@ -0,0 +1,76 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef NOMEX_H
+#define NOMEX_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* The parts of the MEX API used by the solver headers, for programs that are
+ * built without MATLAB, e.g. mex/findmask. The headers include this file
+ * instead of mex.h if MATLAB_MEX_FILE is not defined, which is always defined
+ * by the mex command.
+ *
+ * Like their MATLAB counterparts, the allocators never return NULL and
+ * mexErrMsgTxt does not return. Unlike them, they are thread safe.
+ */
+
+typedef size_t    mwSize;
+typedef size_t    mwIndex;
+typedef ptrdiff_t mwSignedIndex;
+
+static inline void mexErrMsgTxt(
+        const char *msg)
+{
+    fprintf(stderr, "%s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+static inline void *mxCalloc(
+        size_t n,
+        size_t size)
+{
+    void *p = calloc(n > 0 ? n : 1, size);
+    if (!p) { mexErrMsgTxt("Out of memory."); }
+    return p;
+}
+
+static inline void *mxMalloc(
+        size_t size)
+{
+    void *p = malloc(size > 0 ? size : 1);
+    if (!p) { mexErrMsgTxt("Out of memory."); }
+    return p;
+}
+
+static inline void mxFree(
+        void *p)
+{
+    free(p);
+}
+
+/* All memory outlives the calls. */
+static inline void mexMakeMemoryPersistent(
+        void *p)
+{
+    (void) p;
+}
+
+#endif /* NOMEX_H */
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OPNORM_H
+#define OPNORM_H
+
+#include <math.h>
+#include <float.h>
+#ifdef MATLAB_MEX_FILE
+#include "mex.h"
+#include "matrix.h"
+#else
+#include "nomex.h"
+#endif
+#include "inpaintop.h"
+
+/* Estimates the squared operator norm of K = [A B], i.e. the largest eigenvalue
+ * of the symmetric positive semidefinite matrix S = K*K' = A*A' + B*B', with
+ * the Lanczos method.
+ *
+ * After k steps the largest eigenvalue theta of the tridiagonal Lanczos matrix
+ * T_k is a lower bound for the largest eigenvalue of S. The residual of the
+ * Ritz pair is r = beta_k*|s_k|, where s is the normalised eigenvector of T_k
+ * for theta. S has an eigenvalue in [theta-r, theta+r], and theta+r is
+ * returned as estimate of an upper bound (see Zhou and Li, Bounding the
+ * spectrum of large Hermitian matrices, 2011). It is not guaranteed: the
+ * eigenvalue next to theta need not be the largest one if the start vector is
+ * almost orthogonal to the dominant eigenvector. Callers that need a bound
+ * should add a safety factor, see PDHG_NRMSAFE in pdhg.h. The iteration stops
+ * as soon as r <= tol*theta.
+ *
+ * The matrix S is applied through a callback. opnorm_inpaintop provides the
+ * callback for an A given by an inpaintop and a diagonal or sparse B.
+ */
+
+typedef void (*opnorm_mult)(void *data, const double *x, double *y);
+
+/* Size of the work array of opnorm_estimate for n unknowns and maxit steps. */
+#define OPNORM_WORK(n, maxit) (4*(n) + 4*(maxit))
+
+/* Number of eigenvalues of the tridiagonal matrix (a, b) of size k below x. */
+static inline int opnorm_sturm(
+        const double *a,
+        const double *b,
+        int k,
+        double x)
+{
+    int i, cnt = 0;
+    double q = 1.0;
+    for (i = 0; i < k; i++) {
+        q = a[i] - x - ((i > 0) ? b[i-1]*b[i-1]/q : 0.0);
+        if (q == 0.0) { q = -DBL_MIN; }
+        if (q < 0.0) { cnt++; }
+    }
+    return cnt;
+}
+
+/* Largest eigenvalue theta of the tridiagonal matrix (a, b) of size k and the
+ * corresponding normalised eigenvector s. theta is found by bisection, s by two
+ * steps of inverse iteration. d is a work array of size k.
+ */
+static inline double opnorm_tridiag(
+        const double *a,
+        const double *b,
+        int k,
+        double *s,
+        double *d)
+{
+    int i, it;
+    double lo, hi, mid, shift, nrm;
+
+    /* Gershgorin bounds. */
+    lo = hi = a[0];
+    for (i = 0; i < k; i++) {
+        double r = ((i > 0) ? fabs(b[i-1]) : 0.0) + ((i < k-1) ? fabs(b[i]) : 0.0);
+        if (a[i] - r < lo) { lo = a[i] - r; }
+        if (a[i] + r > hi) { hi = a[i] + r; }
+    }
+    for (it = 0; it < 200; it++) {
+        mid = 0.5*(lo + hi);
+        if ((mid <= lo) || (mid >= hi)) { break; }
+        if (opnorm_sturm(a, b, k, mid) == k) { hi = mid; } else { lo = mid; }
+    }
+
+    /* T - shift*I is negative definite. The LDL' factorisation is therefore
+     * stable without pivoting. */
+    shift = hi + 4.0*DBL_EPSILON*fabs(hi) + DBL_MIN;
+    for (i = 0; i < k; i++) { s[i] = 1.0; }
+    for (it = 0; it < 2; it++) {
+        d[0] = a[0] - shift;
+        for (i = 1; i < k; i++) {
+            d[i]  = a[i] - shift - b[i-1]*b[i-1]/d[i-1];
+            s[i] -= b[i-1]/d[i-1]*s[i-1];
+        }
+        s[k-1] /= d[k-1];
+        for (i = k-2; i >= 0; i--) {
+            s[i] = (s[i] - b[i]*s[i+1])/d[i];
+        }
+        nrm = 0.0;
+        for (i = 0; i < k; i++) { nrm += s[i]*s[i]; }
+        nrm = sqrt(nrm);
+        for (i = 0; i < k; i++) { s[i] /= nrm; }
+    }
+    return hi;
+}
+
+/* Runs at most maxit Lanczos steps on S starting from v0. If v0 is NULL or 0,
+ * the iteration starts from the vector of ones. Returns the number of steps.
+ * Each step costs one product with S. work must hold 3*n + 4*maxit entries or
+ * be NULL, in which case it is allocated.
+ *
+ * theta and res receive the largest Ritz value and its residual. If ritz is
+ * not 0 the Ritz vector is written back to v0. The basis is never stored. The
+ * Ritz vector is formed in a second pass that repeats the steps.
+ */
+static inline int opnorm_lanczos(
+        opnorm_mult mult,
+        void *data,
+        mwSize n,
+        double *v0,
+        int maxit,
+        double tol,
+        int ritz,
+        double *work,
+        double *theta,
+        double *res)
+{
+    mwSignedIndex jj, N = (mwSignedIndex) n;
+    int k, pass, steps = 0;
+    double nrm;
+    double *v, *vo, *w, *tmp, *mem = NULL;
+    double *a, *b, *s, *d;
+
+    if (maxit < 1) { maxit = 1; }
+    if (!v0) { ritz = 0; }
+
+    if (!work) {
+        work = mem = mxCalloc(3*n + 4*maxit, sizeof(double));
+    }
+    v  = work;
+    vo = v  + n;
+    w  = vo + n;
+    a  = w  + n;
+    b  = a  + maxit;
+    s  = b  + maxit;
+    d  = s  + maxit;
+
+    *theta = 0.0;
+    *res   = 0.0;
+
+    for (pass = 0; pass < (ritz ? 2 : 1); pass++) {
+        /* Normalised start vector. */
+        nrm = 0.0;
+        if (v0) {
+            for (jj = 0; jj < N; jj++) { nrm += v0[jj]*v0[jj]; }
+        }
+        for (jj = 0; jj < N; jj++) {
+            v[jj]  = (nrm > 0.0) ? v0[jj]/sqrt(nrm) : 1.0/sqrt((double) n);
+            vo[jj] = 0.0;
+        }
+        if (pass == 1) {
+            for (jj = 0; jj < N; jj++) { v0[jj] = s[0]*v[jj]; }
+        }
+
+        for (k = 0; k < ((pass == 0) ? maxit : steps-1); k++) {
+            double ak = 0.0, bk = 0.0, bo = (k > 0) ? b[k-1] : 0.0;
+
+            /* w = S*v - beta_{k-1}*v_{k-1} - alpha_k*v_k */
+            mult(data, v, w);
+            #pragma omp parallel for schedule(static) reduction(+:ak)
+            for (jj = 0; jj < N; jj++) { ak += w[jj]*v[jj]; }
+            #pragma omp parallel for schedule(static) reduction(+:bk)
+            for (jj = 0; jj < N; jj++) {
+                w[jj] -= ak*v[jj] + bo*vo[jj];
+                bk    += w[jj]*w[jj];
+            }
+            bk = sqrt(bk);
+
+            if (pass == 0) {
+                a[k]   = ak;
+                b[k]   = bk;
+                steps  = k+1;
+                *theta = opnorm_tridiag(a, b, steps, s, d);
+                *res   = bk*fabs(s[k]);
+                if ((*res <= tol*(*theta)) || (bk <= DBL_EPSILON*(*theta))) { break; }
+            }
+
+            /* Next basis vector. */
+            tmp = vo; vo = v; v = w; w = tmp;
+            for (jj = 0; jj < N; jj++) { v[jj] /= b[k]; }
+
+            if (pass == 1) {
+                for (jj = 0; jj < N; jj++) { v0[jj] += s[k+1]*v[jj]; }
+            }
+        }
+    }
+
+    if (mem) { mxFree(mem); }
+    return steps;
+}
+
+/* Callback data for S = A*A' + B*B' with A given by an inpaintop. B is either
+ * diagonal (b != NULL) or a sparse matrix given by a second inpaintop. */
+typedef struct {
+    inpaintop *A;
+    inpaintop *B;
+    const double *b;
+    double *t;           /* Work array. */
+} opnorm_data;
+
+static inline void opnorm_inpaintop(
+        void *data,
+        const double *x,
+        double *y)
+{
+    opnorm_data *d = data;
+    mwSignedIndex jj, N = d->A->n;
+
+    /* y = A*(A'*x) */
+    inpaintop_prepare(d->A, x, 1);
+    #pragma omp parallel for schedule(static)
+    for (jj = 0; jj < N; jj++) { d->t[jj] = inpaintop_rowt(d->A, x, jj); }
+    inpaintop_prepare(d->A, d->t, 0);
+    #pragma omp parallel for schedule(static)
+    for (jj = 0; jj < N; jj++) { y[jj] = inpaintop_row(d->A, d->t, jj); }
+
+    /* y += B*(B'*x) */
+    if (d->b) {
+        #pragma omp parallel for schedule(static)
+        for (jj = 0; jj < N; jj++) { y[jj] += d->b[jj]*d->b[jj]*x[jj]; }
+    } else if (d->B) {
+        inpaintop_prepare(d->B, x, 1);
+        #pragma omp parallel for schedule(static)
+        for (jj = 0; jj < N; jj++) { d->t[jj] = inpaintop_rowt(d->B, x, jj); }
+        inpaintop_prepare(d->B, d->t, 0);
+        #pragma omp parallel for schedule(static)
+        for (jj = 0; jj < N; jj++) { y[jj] += inpaintop_row(d->B, d->t, jj); }
+    }
+}
+
+/* Estimates the norm of [A diag(b)] or [A B]. Returns the number of products
+ * with [A B] and its transpose. nrm receives the Ritz estimate, bnd the Ritz
+ * value plus residual, both for the norm (not its square). v0 is the start vector and may be
+ * NULL, see opnorm_lanczos. work must hold OPNORM_WORK(n, maxit) entries or be
+ * NULL. Nothing is allocated if work is given, so that the estimate can run
+ * inside a parallel region.
+ */
+static inline int opnorm_estimate(
+        inpaintop *A,
+        inpaintop *B,
+        const double *b,
+        double *v0,
+        int maxit,
+        double tol,
+        int ritz,
+        double *work,
+        double *nrm,
+        double *bnd)
+{
+    opnorm_data d;
+    double theta, res;
+    int k;
+
+    d.A = A;
+    d.B = B;
+    d.b = b;
+    d.t = work ? work : mxCalloc(A->n, sizeof(double));
+
+    if (maxit < 1) { maxit = 1; }
+    k = opnorm_lanczos(opnorm_inpaintop, &d, A->n, v0, maxit, tol, ritz,
+            work ? work + A->n : NULL, &theta, &res);
+
+    if (!work) { mxFree(d.t); }
+    *nrm = sqrt(theta);
+    *bnd = sqrt(theta + res);
+    return ((ritz && v0) ? 4 : 2)*k;
+}
+
+#endif /* OPNORM_H */
@@ -0,0 +1,512 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef PDHG_H
+#define PDHG_H
+
+#include <math.h>
+#include <string.h>
+#ifdef MATLAB_MEX_FILE
+#include "mex.h"
+#include "matrix.h"
+#else
+#include "nomex.h"
+#endif
+#include "inpaintop.h"
+#include "opnorm.h"
+
+/* Primal dual hybrid gradient method (Chambolle and Pock) for the linearised
+ * mask optimisation problem
+ *
+ *   min 1/2 |u-f|^2 + R(c) + eps/2 |c|^2 + mu/2 |c-cbar|^2
+ *   s.t. A*u + diag(b)*c = g
+ *
+ * with one of the following regularisers R of the mask:
+ *
+ * PDHG_L1          lambda |c|_1
+ * PDHG_L2          lambda/2 |c|^2
+ * PDHG_ELASTICNET  lambda (|c|_1 + kappa/2 |c|^2)
+ * PDHG_BOX         lambda |c|_1 subject to 0 <= c <= kappa
+ * PDHG_HUBER       lambda sum_i H(c_i) with H(x) = x^2/(2 kappa) for
+ *                  |x| <= kappa and |x| - kappa/2 otherwise.
+ *
+ * The workspace holds the iterates and the estimate for the norm of [A diag(b)]
+ * together with the Ritz vector of its estimate, see opnorm.h. It can be kept
+ * alive between calls, in which case the next solve starts from the previous
+ * iterates and the Lanczos method starts from the previous Ritz vector.
+ */
+
+/* Relative tolerance and maximal number of Lanczos steps for the estimate of
+ * the operator norm. The Ritz value plus residual of opnorm_estimate is not a
+ * guaranteed upper bound, so it is enlarged by PDHG_NRMSAFE before it enters
+ * the step sizes. */
+#define PDHG_NRMTOL  1e-3
+#define PDHG_NRMIT   50
+#define PDHG_NRMSAFE 1.01
+
+/* Regularisers and precisions, see pdhgpar. */
+enum { PDHG_L1, PDHG_L2, PDHG_ELASTICNET, PDHG_BOX, PDHG_HUBER };
+enum { PDHG_DOUBLE, PDHG_SINGLE, PDHG_MIXED };
+
+typedef struct {
+    mwSize n;            /* Number of unknowns.                             */
+
+    double *u, *ub;      /* Solution and its extrapolation.                 */
+    double *c, *cba;     /* Mask and its extrapolation.                     */
+    double *y;           /* Dual variable.                                  */
+
+    double *ev;          /* Ritz vector of the norm estimate.               */
+    double  nrm;         /* Bound for the norm of [A diag(b)].              */
+
+    double  tau;         /* Primal step size of the last solve.             */
+} pdhgws;
+
+/* Parameters of a solve, see pdhg_args. */
+typedef struct {
+    int    reg;          /* Regulariser, one of the PDHG_L1, ... constants. */
+    double eps, mu;      /* Weights of the quadratic terms of the energy.   */
+    double lambda;       /* Weight of the regulariser.                      */
+    double kappa;        /* Parameter of the regulariser.                   */
+    double L, tol;       /* Maximal number of iterations and tolerance.     */
+    double gamma;        /* Acceleration, see PockChambolleMex.c.           */
+    double alpha;        /* Adaptivity of the step sizes.                   */
+    int    prec;         /* One of the PDHG_DOUBLE, ... constants.          */
+    int    polish;       /* Finish low precision solves in double.          */
+} pdhgpar;
+
+/* Allocates a workspace for n unknowns. All iterates start at 0. */
+static inline void pdhg_alloc(
+        pdhgws *ws,
+        mwSize n)
+{
+    mwSize jj;
+
+    ws->n   = n;
+    ws->u   = mxCalloc(n, sizeof(double));
+    ws->ub  = mxCalloc(n, sizeof(double));
+    ws->c   = mxCalloc(n, sizeof(double));
+    ws->cba = mxCalloc(n, sizeof(double));
+    ws->y   = mxCalloc(n, sizeof(double));
+    ws->ev  = mxCalloc(n, sizeof(double));
+    ws->nrm = 0.0;
+    ws->tau = 0.25;
+
+    /* Initialise the start vector with 1. */
+    for ( jj = 0; jj < n; jj++ ) { ws->ev[jj] = 1.0; }
+}
+
+/* Keeps the memory of the workspace alive after the MEX function returns. */
+static inline void pdhg_persistent(
+        pdhgws *ws)
+{
+    mexMakeMemoryPersistent(ws->u);
+    mexMakeMemoryPersistent(ws->ub);
+    mexMakeMemoryPersistent(ws->c);
+    mexMakeMemoryPersistent(ws->cba);
+    mexMakeMemoryPersistent(ws->y);
+    mexMakeMemoryPersistent(ws->ev);
+}
+
+/* Sets all iterates to 0 and drops the norm estimate. */
+static inline void pdhg_reset(
+        pdhgws *ws)
+{
+    mwSize jj;
+
+    memset(ws->u,   0, ws->n*sizeof(double));
+    memset(ws->ub,  0, ws->n*sizeof(double));
+    memset(ws->c,   0, ws->n*sizeof(double));
+    memset(ws->cba, 0, ws->n*sizeof(double));
+    memset(ws->y,   0, ws->n*sizeof(double));
+    for ( jj = 0; jj < ws->n; jj++ ) { ws->ev[jj] = 1.0; }
+    ws->nrm = 0.0;
+    ws->tau = 0.25;
+}
+
+/* Frees the memory allocated by pdhg_alloc. */
+static inline void pdhg_free(
+        pdhgws *ws)
+{
+    mxFree(ws->u);
+    mxFree(ws->ub);
+    mxFree(ws->c);
+    mxFree(ws->cba);
+    mxFree(ws->y);
+    mxFree(ws->ev);
+}
+
+/* Estimates the norm of [A diag(b)] with at most maxit Lanczos steps and the
+ * relative tolerance tol, starting from the Ritz vector in the workspace. The
+ * norm used for the step sizes is PDHG_NRMSAFE times the Ritz value plus
+ * residual. If
+ * keep is not 0 the new Ritz vector is stored for the next call. work is
+ * passed on to opnorm_estimate and may be NULL. Returns the number of products
+ * with [A diag(b)] and its transpose.
+ */
+static inline int pdhg_norm(
+        pdhgws *ws,
+        inpaintop *op,
+        const double *b,
+        int maxit,
+        double tol,
+        int keep,
+        double *work)
+{
+    double nrm, bnd;
+    int k = opnorm_estimate(op, NULL, b, ws->ev, maxit, tol, keep, work, &nrm, &bnd);
+    ws->nrm = PDHG_NRMSAFE*bnd;
+    return k;
+}
+
+/* Float copies of the iterates and of the data. */
+typedef struct {
+    mwSize n;
+    float *u, *ub, *c, *cba, *y;
+    float *f, *cb, *b, *g;
+    double nrm, tau;
+} pdhgwsf;
+
+/* Number of low precision iterations between two checks in double precision,
+ * the factor by which the residual must decrease between two checks and the
+ * tolerance on the residual relative to |g|. PockTol bounds the distances of
+ * the iterates and is far below what float iterates can reach, so the residual
+ * gets its own tolerance, a few hundred times the float precision. */
+#define PDHG_REFRESH 50
+#define PDHG_STALL   0.9
+#define PDHG_RESTOL  1e-5
+
+/* State of the checks in double precision. The residual |A*u + b.*c - g| is
+ * evaluated for the float iterates with the double operator. */
+typedef struct {
+    inpaintop *op;
+    const double *b, *g;
+    double *u, *c;       /* Double copies of the float iterates.            */
+    double tol;          /* PDHG_RESTOL*|g|.                                */
+    double res;          /* Residual of the last check, negative if none.   */
+} pdhg_refresh_t;
+
+/* Returns 1 if the low precision iteration should stop, i.e. the residual is
+ * below tol or did not decrease by PDHG_STALL since the last check. Round off
+ * errors then dominate the progress of the float iterates.
+ */
+static inline int pdhg_refresh(
+        pdhg_refresh_t *rf,
+        const pdhgwsf *ws)
+{
+    mwSignedIndex jj, N = (mwSignedIndex) ws->n;
+    double res = 0.0, old = rf->res;
+
+    #pragma omp parallel for schedule(static)
+    for ( jj = 0; jj < N; jj++ ) {
+        rf->u[jj] = ws->u[jj];
+        rf->c[jj] = ws->c[jj];
+    }
+    inpaintop_prepare(rf->op, rf->u, 0);
+    #pragma omp parallel for schedule(static) reduction(+:res)
+    for ( jj = 0; jj < N; jj++ ) {
+        double r = inpaintop_row(rf->op, rf->u, jj) + rf->b[jj]*rf->c[jj] - rf->g[jj];
+        res += r*r;
+    }
+    res = sqrt(res);
+    rf->res = res;
+
+    return (res <= rf->tol) || ((old >= 0.0) && (res > PDHG_STALL*old));
+}
+
+/* Proxes of the regularisers.
+ *
+ * With d = 1+tau*eps+tau*mu, the update of the mask is
+ *
+ *   c = argmin tau*R(x) + d/2 |x - s/d|^2,   s = c - tau*b.*y + tau*mu*cbar.
+ *
+ * pdhg_init_* computes the constants k of the prox for the step size tau once
+ * per iteration. PDHG_PROX_* evaluates the prox at s in the precision of the
+ * arithmetic. The proxes are macros without branches on the regulariser, so
+ * that every regulariser gets its own inner loop, see pdhg_r.h. A new
+ * regulariser needs an init function, a prox, an entry in the enum and an
+ * instantiation below.
+ */
+#define PDHG_SGN(x)  ((x) > 0 ? (PDHG_ACC) 1 : (PDHG_ACC) -1)
+#define PDHG_MAX0(x) ((x) > 0 ? (x) : (PDHG_ACC) 0)
+
+/* Soft shrinkage, used by PDHG_L1 and PDHG_ELASTICNET. */
+#define PDHG_PROX_SHRINK(s, k) \
+    (PDHG_SGN(s) * PDHG_MAX0((PDHG_FABS(s) - k[0]) * k[1]))
+
+#define PDHG_PROX_L2(s, k) \
+    ((s) * k[1])
+
+#define PDHG_PROX_BOX(s, k) \
+    (PDHG_MAX0(((s) - k[0]) * k[1]) < k[2] ? PDHG_MAX0(((s) - k[0]) * k[1]) : k[2])
+
+#define PDHG_PROX_HUBER(s, k) \
+    (PDHG_FABS((s)*k[0]) <= k[2] ? (s)*k[0]*k[3] : (s)*k[0] - PDHG_SGN(s)*k[1])
+
+static inline void pdhg_init_l1(
+        double *k,
+        double tau,
+        const pdhgpar *p)
+{
+    k[0] = tau*p->lambda;
+    k[1] = 1.0/(1.0+tau*p->eps+tau*p->mu);
+    k[2] = k[3] = 0.0;
+}
+
+static inline void pdhg_init_l2(
+        double *k,
+        double tau,
+        const pdhgpar *p)
+{
+    k[1] = 1.0/(1.0+tau*p->eps+tau*p->mu+tau*p->lambda);
+    k[0] = k[2] = k[3] = 0.0;
+}
+
+static inline void pdhg_init_elasticnet(
+        double *k,
+        double tau,
+        const pdhgpar *p)
+{
+    k[0] = tau*p->lambda;
+    k[1] = 1.0/(1.0+tau*p->eps+tau*p->mu+tau*p->lambda*p->kappa);
+    k[2] = k[3] = 0.0;
+}
+
+static inline void pdhg_init_box(
+        double *k,
+        double tau,
+        const pdhgpar *p)
+{
+    k[0] = tau*p->lambda;
+    k[1] = 1.0/(1.0+tau*p->eps+tau*p->mu);
+    k[2] = p->kappa;
+    k[3] = 0.0;
+}
+
+/* With z = s/d and t = tau*lambda/d, the prox is z*kappa/(kappa+t) for
+ * |z| <= kappa+t and z - t*sgn(z) otherwise. */
+static inline void pdhg_init_huber(
+        double *k,
+        double tau,
+        const pdhgpar *p)
+{
+    k[0] = 1.0/(1.0+tau*p->eps+tau*p->mu);
+    k[1] = tau*p->lambda*k[0];
+    k[2] = p->kappa + k[1];
+    k[3] = (k[2] > 0.0) ? p->kappa/k[2] : 0.0;
+}
+
+#define PDHG_CAT_(a, b) a##b
+#define PDHG_CAT(a, b)  PDHG_CAT_(a, b)
+
+#define PDHG_REG(f)  f##_l1
+#define PDHG_INIT    pdhg_init_l1
+#define PDHG_PROX    PDHG_PROX_SHRINK
+#include "pdhg_r.h"
+
+#define PDHG_REG(f)  f##_l2
+#define PDHG_INIT    pdhg_init_l2
+#define PDHG_PROX    PDHG_PROX_L2
+#include "pdhg_r.h"
+
+#define PDHG_REG(f)  f##_elasticnet
+#define PDHG_INIT    pdhg_init_elasticnet
+#define PDHG_PROX    PDHG_PROX_SHRINK
+#include "pdhg_r.h"
+
+#define PDHG_REG(f)  f##_box
+#define PDHG_INIT    pdhg_init_box
+#define PDHG_PROX    PDHG_PROX_BOX
+#include "pdhg_r.h"
+
+#define PDHG_REG(f)  f##_huber
+#define PDHG_INIT    pdhg_init_huber
+#define PDHG_PROX    PDHG_PROX_HUBER
+#include "pdhg_r.h"
+
+/* The iterations of all regularisers, in the order of the enum. */
+typedef int (*pdhg_iter_d)(pdhgws *, inpaintop *, const double *, const double *,
+        const double *, const double *, const pdhgpar *, double, double *, double *);
+typedef int (*pdhg_iter_f)(pdhgwsf *, inpaintop *, const float *, const float *,
+        const float *, const float *, const pdhgpar *, double, double *, double *,
+        pdhg_refresh_t *);
+
+static const pdhg_iter_d pdhg_iter_double[] = {
+    pdhg_iter_l1,   pdhg_iter_l2,   pdhg_iter_elasticnet,   pdhg_iter_box,   pdhg_iter_huber };
+static const pdhg_iter_f pdhg_iter_single[] = {
+    pdhg_iter_l1_s, pdhg_iter_l2_s, pdhg_iter_elasticnet_s, pdhg_iter_box_s, pdhg_iter_huber_s };
+static const pdhg_iter_f pdhg_iter_mixed[] = {
+    pdhg_iter_l1_m, pdhg_iter_l2_m, pdhg_iter_elasticnet_m, pdhg_iter_box_m, pdhg_iter_huber_m };
+
+#ifdef MATLAB_MEX_FILE
+/* Returns the position of the name in the MEX argument arg in the list names
+ * of length n. msg is the error message for an invalid name. */
+static inline int pdhg_lookup(
+        const mxArray *arg,
+        const char **names,
+        int n,
+        const char *msg)
+{
+    char name[16];
+    int k;
+
+    if (mxIsChar(arg) && !mxGetString(arg, name, sizeof(name))) {
+        for (k = 0; k < n; k++) {
+            if (!strcmp(name, names[k])) { return k; }
+        }
+    }
+    mexErrMsgTxt(msg);
+    return 0;
+}
+
+/* Reads the parameters eps, mu, lambda, L, tol, gamma, alpha, prec, polish,
+ * reg and kappa from the MEX arguments prhs, see PockChambolleMex.c. The last
+ * six are optional.
+ */
+static inline void pdhg_args(
+        pdhgpar *par,
+        int nrhs,
+        const mxArray *prhs[])
+{
+    static const char *precs[] = { "double", "single", "mixed" };
+    static const char *regs[]  = { "l1", "l2", "elasticnet", "box", "huber" };
+
+    if (nrhs < 5) {
+        mexErrMsgTxt("Not enough input arguments.");
+    }
+    if (nrhs > 11) {
+        mexErrMsgTxt("Too many input arguments.");
+    }
+
+    par->eps    = mxGetScalar(prhs[0]);
+    par->mu     = mxGetScalar(prhs[1]);
+    par->lambda = mxGetScalar(prhs[2]);
+    par->L      = mxGetScalar(prhs[3]);
+    par->tol    = mxGetScalar(prhs[4]);
+    par->gamma  = (nrhs > 5) ? mxGetScalar(prhs[5]) : 0.0;
+    par->alpha  = (nrhs > 6) ? mxGetScalar(prhs[6]) : 0.0;
+    par->prec   = (nrhs > 7) ? pdhg_lookup(prhs[7], precs, 3,
+            "Unknown precision. Use 'double', 'single' or 'mixed'.") : PDHG_DOUBLE;
+    par->polish = (nrhs > 8) ? (mxGetScalar(prhs[8]) != 0.0) : 1;
+    par->reg    = (nrhs > 9) ? pdhg_lookup(prhs[9], regs, 5,
+            "Unknown regulariser. Use 'l1', 'l2', 'elasticnet', 'box' or 'huber'.") : PDHG_L1;
+    par->kappa  = (nrhs > 10) ? mxGetScalar(prhs[10]) : 1.0;
+}
+#endif /* MATLAB_MEX_FILE */
+
+/* Runs at most par->L iterations of the PDHG method, starting from the
+ * iterates in the workspace. The distances between the last two iterates are
+ * returned in du and dc. Returns the number of iterations.
+ *
+ * In single and mixed precision, the iterates are rounded to float and the
+ * iteration runs until it converges, stalls in the sense of pdhg_refresh, or
+ * reaches L iterations. The float iterates are then copied back to the
+ * workspace. If par->polish is not 0, the remaining iterations are carried out
+ * in double precision, starting from these iterates. nlow receives the number
+ * of low precision iterations.
+ *
+ * Storing the iterates in float halves the memory traffic of each sweep. Since
+ * the iteration is limited by the memory bandwidth, this is what makes the low
+ * precision faster.
+ */
+static inline int pdhg_solve(
+        pdhgws *ws,
+        inpaintop *op,
+        const double *f,
+        const double *cb,
+        const double *b,
+        const double *g,
+        const pdhgpar *par,
+        double *du,
+        double *dc,
+        int *nlow)
+{
+    pdhgwsf wf;
+    pdhg_refresh_t rf;
+    mwSignedIndex jj, N = (mwSignedIndex) ws->n;
+    double gn = 0.0;
+    int ii;
+
+    *nlow = 0;
+    if (par->prec == PDHG_DOUBLE) {
+        return pdhg_iter_double[par->reg](ws, op, f, cb, b, g, par, par->L, du, dc);
+    }
+
+    inpaintop_lowprec(op);
+
+    wf.n   = ws->n;
+    wf.nrm = ws->nrm;
+    wf.tau = ws->tau;
+    wf.u   = mxCalloc(ws->n, sizeof(float));
+    wf.ub  = mxCalloc(ws->n, sizeof(float));
+    wf.c   = mxCalloc(ws->n, sizeof(float));
+    wf.cba = mxCalloc(ws->n, sizeof(float));
+    wf.y   = mxCalloc(ws->n, sizeof(float));
+    wf.f   = mxCalloc(ws->n, sizeof(float));
+    wf.cb  = mxCalloc(ws->n, sizeof(float));
+    wf.b   = mxCalloc(ws->n, sizeof(float));
+    wf.g   = mxCalloc(ws->n, sizeof(float));
+
+    #pragma omp parallel for schedule(static) reduction(+:gn)
+    for ( jj = 0; jj < N; jj++ ) {
+        gn += g[jj]*g[jj];
+        wf.u[jj]  = (float) ws->u[jj];
+        wf.c[jj]  = (float) ws->c[jj];
+        wf.y[jj]  = (float) ws->y[jj];
+        wf.f[jj]  = (float) f[jj];
+        wf.cb[jj] = (float) cb[jj];
+        wf.b[jj]  = (float) b[jj];
+        wf.g[jj]  = (float) g[jj];
+    }
+
+    rf.op  = op;
+    rf.b   = b;
+    rf.g   = g;
+    rf.u   = ws->u;
+    rf.c   = ws->c;
+    rf.tol = PDHG_RESTOL*sqrt(gn);
+    rf.res = -1.0;
+
+    ii = ((par->prec == PDHG_SINGLE) ? pdhg_iter_single : pdhg_iter_mixed)[par->reg](
+            &wf, op, wf.f, wf.cb, wf.b, wf.g, par, par->L, du, dc, &rf);
+
+    #pragma omp parallel for schedule(static)
+    for ( jj = 0; jj < N; jj++ ) {
+        ws->u[jj] = wf.u[jj];
+        ws->c[jj] = wf.c[jj];
+        ws->y[jj] = wf.y[jj];
+    }
+    ws->tau = wf.tau;
+    *nlow   = ii;
+
+    mxFree(wf.u);
+    mxFree(wf.ub);
+    mxFree(wf.c);
+    mxFree(wf.cba);
+    mxFree(wf.y);
+    mxFree(wf.f);
+    mxFree(wf.cb);
+    mxFree(wf.b);
+    mxFree(wf.g);
+
+    if (par->polish && (ii < par->L)) {
+        ii += pdhg_iter_double[par->reg](ws, op, f, cb, b, g, par, par->L - ii, du, dc);
+    }
+    return ii;
+}
+
+#endif /* PDHG_H */
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Instantiates the PDHG iteration of pdhg_t.h for one regulariser in all three
+ * precisions, see pdhg.h.
+ *
+ * The following macros must be defined:
+ *
+ * PDHG_REG(f)   name of the function f for this regulariser.
+ * PDHG_INIT     constants of the prox, see pdhg.h.
+ * PDHG_PROX     prox of the regulariser, see pdhg.h.
+ *
+ * This yields PDHG_REG(pdhg_iter) for double precision and the single and
+ * mixed precision versions with the suffixes _s and _m. The macros are
+ * undefined at the end of the file.
+ */
+
+#define PDHG_REAL    double
+#define PDHG_ACC     double
+#define PDHG_FABS    fabs
+#define PDHG_WS      pdhgws
+#define PDHG_LOWPREC 0
+#define PDHG_NAME(f) PDHG_REG(f)
+#define PDHG_OP(f)   f
+#include "pdhg_t.h"
+
+#define PDHG_REAL    float
+#define PDHG_ACC     float
+#define PDHG_FABS    fabsf
+#define PDHG_WS      pdhgwsf
+#define PDHG_LOWPREC 1
+#define PDHG_NAME(f) PDHG_CAT(PDHG_REG(f), _s)
+#define PDHG_OP(f)   f##_s
+#include "pdhg_t.h"
+
+#define PDHG_REAL    float
+#define PDHG_ACC     double
+#define PDHG_FABS    fabs
+#define PDHG_WS      pdhgwsf
+#define PDHG_LOWPREC 1
+#define PDHG_NAME(f) PDHG_CAT(PDHG_REG(f), _m)
+#define PDHG_OP(f)   f##_m
+#include "pdhg_t.h"
+
+#undef PDHG_REG
+#undef PDHG_INIT
+#undef PDHG_PROX
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* The PDHG iteration of pdhg.h for one regulariser and one floating point type.
+ *
+ * This file is included by pdhg_r.h once for every precision, with the
+ * following macros defined:
+ *
+ * PDHG_REAL     type of the iterates and of the data.
+ * PDHG_ACC      type used for the arithmetic.
+ * PDHG_FABS     fabs for PDHG_ACC.
+ * PDHG_WS       type of the workspace.
+ * PDHG_LOWPREC  1 if PDHG_REAL is float, 0 otherwise.
+ * PDHG_NAME(f)  name of the function f in this precision.
+ * PDHG_OP(f)    name of the inpaintop function f in this precision.
+ * PDHG_INIT     constants of the prox of the regulariser, see pdhg.h.
+ * PDHG_PROX     prox of the regulariser, see pdhg.h.
+ *
+ * Reductions are always carried out in double precision. The macros that
+ * depend on the precision are undefined at the end of the file.
+ */
+
+/* Runs at most L iterations, starting from the iterates in the workspace. The
+ * step sizes are derived from the norm bound in the workspace, see
+ * pdhg_norm. The parameters of the energy and of the step sizes are taken
+ * from par, see pdhgpar. The distances between the last two iterates are
+ * returned in du and dc. Returns the number of iterations.
+ *
+ * The low precision versions additionally stop as soon as pdhg_refresh says
+ * so. It is called every PDHG_REFRESH iterations if rf is not NULL.
+ */
+static inline int PDHG_NAME(pdhg_iter)(
+        PDHG_WS *ws,
+        inpaintop *op,
+        const PDHG_REAL *f,
+        const PDHG_REAL *cb,
+        const PDHG_REAL *b,
+        const PDHG_REAL *g,
+        const pdhgpar *par,
+        double L,
+        double *du_,
+#if PDHG_LOWPREC
+        double *dc_,
+        pdhg_refresh_t *rf)
+#else
+        double *dc_)
+#endif
+{
+    int ii;
+    mwSignedIndex jj, N = (mwSignedIndex) ws->n;
+    PDHG_REAL *u = ws->u, *ub = ws->ub, *c = ws->c, *cba = ws->cba, *y = ws->y;
+
+    double du = 0.0, dc = 0.0;              /* distance between the iterates. */
+    double pr, dr;                          /* primal and dual residuals.     */
+
+    /* Squared operator norm. */
+    double lam = ws->nrm*ws->nrm;
+
+    /* Set step sizes */
+    double tau = ws->tau;
+    double sigma = 1.0/((lam+0.1)*tau);
+    double theta = 1.0;
+
+    double tol = par->tol, gamma = par->gamma, alpha = par->alpha;
+    double mu  = par->mu;
+
+    double k[4];                                  /* Constants of the prox. */
+    double dummyu;                                              /* Time saver */
+
+    /* The extrapolations start at the initial iterates. */
+    for ( jj = 0; jj < N; jj++ ) {
+        ub[jj]  = u[jj];
+        cba[jj] = c[jj];
+    }
+
+    for ( ii = 0; ii < L; ii++ )
+    {
+        /* Step sizes and parameters in the precision of the arithmetic. */
+        const PDHG_ACC sg = (PDHG_ACC) sigma;
+
+        /* Update y:
+         * y = y + sigma * ( A*ub + b*cb - g )
+         */
+        PDHG_OP(inpaintop_prepare)(op, ub, 0);
+        dr = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:dr)
+        for ( jj = 0; jj < N; jj++ )
+        {
+            PDHG_ACC r = PDHG_OP(inpaintop_row)(op, ub, jj) + (PDHG_ACC) b[jj] * cba[jj] - g[jj];
+            y[jj]  = (PDHG_REAL) (y[jj] + sg * r);
+            dr    += (double) r*r;
+        }
+
+        PDHG_OP(inpaintop_prepare)(op, y, 1);
+
+        /* Adaptive step sizes, theta_n = 1/sqrt(1+2*gamma*tau_n). */
+        if (gamma > 0.0) { theta = 1.0/sqrt(1.0+2.0*gamma*tau); }
+        PDHG_INIT(k, tau, par);
+        dummyu = 1.0/(1.0+tau);
+
+        const PDHG_ACC ta = (PDHG_ACC) tau,    th  = (PDHG_ACC) theta;
+        const PDHG_ACC mm = (PDHG_ACC) mu,     du1 = (PDHG_ACC) dummyu;
+        const PDHG_ACC kp[4] = { (PDHG_ACC) k[0], (PDHG_ACC) k[1],
+                                 (PDHG_ACC) k[2], (PDHG_ACC) k[3] };
+
+        du = 0.0;
+        dc = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:du,dc)
+        for ( jj = 0; jj < N; jj++ )
+        {
+            PDHG_ACC uold = u[jj];
+            PDHG_ACC cold = c[jj];
+            PDHG_ACC unew, cnew, shift;
+
+            /* Update u:
+             * u = 1/(1+tau) * ( u - tau*( A'*y - f) )
+             */
+            unew  = du1 * (uold - ta*(PDHG_OP(inpaintop_rowt)(op, y, jj) - f[jj]));
+            u[jj] = (PDHG_REAL) unew;
+            /* Update c:
+             * c = prox( c - tau*B*y + tau*mu*cb ), see pdhg.h.
+             */
+            shift = cold - ta*b[jj]*y[jj] + ta*mm*cb[jj];
+            cnew  = PDHG_PROX(shift, kp);
+            c[jj] = (PDHG_REAL) cnew;
+
+            /* Update ub and cba:
+             * ub = u + theta*(u-uold);
+             * cb = c + theta*(c-cold);
+             */
+            ub[jj]  = (PDHG_REAL) (unew + th*(unew-uold));
+            cba[jj] = (PDHG_REAL) (cnew + th*(cnew-cold));
+
+            /* Squared distance between two iterates. */
+            du += (double) (unew-uold)*(unew-uold);
+            dc += (double) (cnew-cold)*(cnew-cold);
+        }
+        /* Residuals of the optimality conditions. Since u and c are updated
+         * with the new y, the primal residual is the step divided by tau. The
+         * dual residual is the constraint violation at the extrapolation.
+         */
+        pr = sqrt(du+dc)/tau;
+        dr = sqrt(dr);
+
+        du = sqrt(du);
+        dc = sqrt(dc);
+
+        /* tau_{n+1} = theta_n*tau_n, sigma_{n+1} = sigma_n/theta_n. */
+        if (gamma > 0.0) {
+            tau   = theta*tau;
+            sigma = sigma/theta;
+        }
+
+        /* Balance primal and dual residuals. */
+        if (alpha > 0.0) {
+            if ( pr > 1.5*dr ) {
+                tau   = tau/(1.0-alpha);
+                sigma = sigma*(1.0-alpha);
+                alpha = 0.95*alpha;
+            } else if ( 1.5*pr < dr ) {
+                tau   = tau*(1.0-alpha);
+                sigma = sigma/(1.0-alpha);
+                alpha = 0.95*alpha;
+            }
+        }
+        /* Both updates keep the product tau*sigma constant. */
+
+        /* Stop if change has become small enough */
+        if ((ii > 1) && (du < tol) && (dc < tol)) {
+            break;
+        }
+
+#if PDHG_LOWPREC
+        /* Check the progress in double precision. */
+        if (rf && (((ii+1) % PDHG_REFRESH) == 0) && pdhg_refresh(rf, ws)) {
+            break;
+        }
+#endif
+    }
+
+    /* The balanced step size is a good guess for the next solve. The
+     * accelerated step sizes start over. */
+    if (gamma <= 0.0) { ws->tau = tau; }
+
+    *du_ = du;
+    *dc_ = dc;
+    return ii;
+}
+
+#undef PDHG_REAL
+#undef PDHG_ACC
+#undef PDHG_FABS
+#undef PDHG_WS
+#undef PDHG_LOWPREC
+#undef PDHG_NAME
+#undef PDHG_OP
@@ -1,69 +1,250 @@
-#include "mex.h"
-
-void mexFunction( int nlhs,       mxArray *plhs[],
-                  int nrhs, const mxArray *prhs[] 
-                 )
-                
-{   /* Sparse matrix-dense vector product 
-     *       
-     *  Inputs:
-     *           
-     *           A - m x n sparse matrix
-     *           b - n x 1 dense vector
-     *           
-     *  Outputs:
-     *   
-     *           x = A*b
-     *
-     *  Darren Engwirda 2006.       
-     */
-
-    double *s, *b, *x;           
-    int *ir, *jc, i, ncol, k;                          
-    
-    /* Check I/O number */
-    if (nlhs!=1) {
-        mexErrMsgTxt("Incorrect number of outputs");
-    }
-    if (nrhs!=2) {
-        mexErrMsgTxt("Incorrect number of inputs");
-    }
-    
-    /* Brief error checking */
-    
-    ncol = mxGetN(prhs[0]);
-    
-    if ((ncol!=mxGetM(prhs[1])) || (mxGetN(prhs[1])!=1)) {
-        mexErrMsgTxt("Wrong input dimensions");
-    }
-    if (!mxIsSparse(prhs[0])) {
-        mexErrMsgTxt("Matrix must be sparse");
-    }
-    
-    
-    /* Allocate output */
-    plhs[0] = mxCreateDoubleMatrix(mxGetM(prhs[0]), 1, mxREAL);
-    
-    /* I/O pointers */
-    ir = mxGetIr(prhs[0]);      /* Row indexing      */
-    jc = mxGetJc(prhs[0]);      /* Column count      */
-    s  = mxGetPr(prhs[0]);      /* Non-zero elements */
-    b  = mxGetPr(prhs[1]);      /* Rhs vector        */
-    x  = mxGetPr(plhs[0]);      /* Output vector     */
-    
-    
-    /* Multiplication */
-    
-    for (i=0; i<ncol; i++) {            /* Loop through columns */
-     
-        int stop = jc[i+1];
-        double rhs = b[i];
-        
-        for (k=jc[i]; k<stop; k++) {    /* Loop through non-zeros in ith column */
-        
-            x[ir[k]] += s[k] * rhs;
-        }
-    }
-    
-    /* End */
-}
+/*
+ * Copyright 2013 Laurent Hoeltgen <laurent.hoeltgen@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+#include "mex.h"
+#include "matrix.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* compile with -largeArrayDims flag. Add -fopenmp to CFLAGS and LDFLAGS to run
+ * the products on multiple threads.
+ */
+
+/* Products of a sparse matrix with dense vectors. Replaces the single vector
+ * version by Darren Engwirda (2006).
+ *
+ * Signature:
+ * X = smvp(A,B)
+ * X = smvp(A,B,'t')
+ *
+ * A = m x n sparse matrix.
+ * B = dense matrix with n (m for 't') rows. Every column is a right hand side.
+ *
+ * X = A*B, or A'*B if the third argument is 't'.
+ *
+ * A'*B is gathered column wise from the CSC arrays, every entry of X is
+ * computed by a single thread. A*B is scattered column wise like in
+ * inpaintop.h: the columns of A are split into blocks with a similar number of
+ * non-zeros, each thread accumulates its block into a private buffer that
+ * spans only the rows touched by the block, and the buffers are summed row
+ * wise. For banded matrices the buffers are hardly larger than X.
+ *
+ * The right hand sides are processed in panels of SMVP_PANEL columns. Each
+ * index of A is read once per panel. The buffers store the panel row wise, so
+ * that the updates of a non-zero are contiguous.
+ */
+
+#define SMVP_PANEL 8
+
+/* X(:,r) = A'*B(:,r) for r in [r0, r1). */
+static void smvp_t(
+        const mwIndex *ir,
+        const mwIndex *jc,
+        const double *s,
+        mwSize n,
+        const double *B,
+        mwSize ldb,
+        double *X,
+        mwSize ldx,
+        mwSize r0,
+        mwSize r1)
+{
+    mwSignedIndex j;
+
+    #pragma omp parallel for schedule(static)
+    for (j = 0; j < (mwSignedIndex) n; j++) {
+        double acc[SMVP_PANEL] = { 0.0 };
+        mwIndex l;
+        mwSize r;
+
+        for (l = jc[j]; l < jc[j+1]; l++) {
+            const double *b = B + ir[l];
+            for (r = r0; r < r1; r++) { acc[r-r0] += s[l]*b[r*ldb]; }
+        }
+        for (r = r0; r < r1; r++) { X[j + r*ldx] = acc[r-r0]; }
+    }
+}
+
+/* Splits the n columns of A into nblk blocks with a similar number of
+ * non-zeros. Block t is [blk[t], blk[t+1]) and touches the rows
+ * [rlo[t], rhi[t]). Returns the total length of the row ranges.
+ */
+static mwSize smvp_blocks(
+        const mwIndex *ir,
+        const mwIndex *jc,
+        mwSize m,
+        mwSize n,
+        int nblk,
+        mwIndex *blk,
+        mwIndex *rlo,
+        mwIndex *rhi)
+{
+    int t;
+    mwIndex j = 0, l, nnz = jc[n];
+    mwSize len = 0;
+
+    for (t = 0; t < nblk; t++) {
+        blk[t] = j;
+        while ((j < n) && (jc[j] < (nnz/nblk)*(t+1))) { j++; }
+    }
+    blk[nblk] = n;
+
+    for (t = 0; t < nblk; t++) {
+        rlo[t] = m;
+        rhi[t] = 0;
+        for (l = jc[blk[t]]; l < jc[blk[t+1]]; l++) {
+            if (ir[l] <  rlo[t]) { rlo[t] = ir[l]; }
+            if (ir[l] >= rhi[t]) { rhi[t] = ir[l]+1; }
+        }
+        if (rhi[t] < rlo[t]) { rlo[t] = rhi[t] = 0; }
+        len += rhi[t] - rlo[t];
+    }
+    return len;
+}
+
+void mexFunction(
+        int nlhs,       mxArray *plhs[],
+        int nrhs, const mxArray *prhs[]
+        )
+{
+    const mwIndex *ir, *jc;
+    const double *s, *B;
+    double *X;
+    mwSize m, n, k, r0, r1;
+    int trans = 0, nblk = 1;
+    char flag[4];
+
+    if ((nrhs < 2) || (nrhs > 3)) {
+        mexErrMsgTxt("Incorrect number of inputs.");
+    }
+    if (nlhs > 1) {
+        mexErrMsgTxt("Incorrect number of outputs.");
+    }
+    if (!mxIsSparse(prhs[0]) || !mxIsDouble(prhs[0]) || mxIsComplex(prhs[0])) {
+        mexErrMsgTxt("A must be a real sparse matrix.");
+    }
+    if (mxIsSparse(prhs[1]) || !mxIsDouble(prhs[1]) || mxIsComplex(prhs[1])) {
+        mexErrMsgTxt("B must be a real full matrix.");
+    }
+    if (nrhs > 2) {
+        if (!mxIsChar(prhs[2]) || mxGetString(prhs[2], flag, sizeof(flag)) || strcmp(flag, "t")) {
+            mexErrMsgTxt("The third argument must be 't'.");
+        }
+        trans = 1;
+    }
+
+    m  = mxGetM(prhs[0]);
+    n  = mxGetN(prhs[0]);
+    k  = mxGetN(prhs[1]);
+    ir = mxGetIr(prhs[0]);
+    jc = mxGetJc(prhs[0]);
+    s  = mxGetPr(prhs[0]);
+    B  = mxGetPr(prhs[1]);
+
+    if (mxGetM(prhs[1]) != (trans ? m : n)) {
+        mexErrMsgTxt("Wrong input dimensions.");
+    }
+
+    plhs[0] = mxCreateDoubleMatrix(trans ? n : m, k, mxREAL);
+    X = mxGetPr(plhs[0]);
+
+    if (trans) {
+        for (r0 = 0; r0 < k; r0 = r1) {
+            r1 = (r0 + SMVP_PANEL < k) ? r0 + SMVP_PANEL : k;
+            smvp_t(ir, jc, s, n, B, m, X, n, r0, r1);
+        }
+        return;
+    }
+
+#ifdef _OPENMP
+    nblk = omp_get_max_threads();
+#endif
+    if ((mwSize) nblk > n) { nblk = (int) n; }
+    if (nblk <= 1) {
+        /* Plain scatter, no buffers needed. */
+        mwIndex j, l;
+        for (r0 = 0; r0 < k; r0++) {
+            for (j = 0; j < n; j++) {
+                double b = B[j + r0*n];
+                for (l = jc[j]; l < jc[j+1]; l++) { X[ir[l] + r0*m] += s[l]*b; }
+            }
+        }
+        return;
+    }
+
+    {
+        mwIndex *blk = mxCalloc(nblk+1, sizeof(mwIndex));
+        mwIndex *rlo = mxCalloc(nblk,   sizeof(mwIndex));
+        mwIndex *rhi = mxCalloc(nblk,   sizeof(mwIndex));
+        mwIndex *off = mxCalloc(nblk,   sizeof(mwIndex));
+        mwSize len = smvp_blocks(ir, jc, m, n, nblk, blk, rlo, rhi);
+        mwSize p = (k < SMVP_PANEL) ? k : SMVP_PANEL;
+        double *buf;
+        int t;
+
+        off[0] = 0;
+        for (t = 1; t < nblk; t++) { off[t] = off[t-1] + (rhi[t-1] - rlo[t-1])*p; }
+        buf = mxCalloc(len*p > 0 ? len*p : 1, sizeof(double));
+
+        for (r0 = 0; r0 < k; r0 = r1) {
+            mwSignedIndex i;
+            mwSize w;
+
+            r1 = (r0 + SMVP_PANEL < k) ? r0 + SMVP_PANEL : k;
+            w  = r1 - r0;
+
+            #pragma omp parallel for schedule(static, 1)
+            for (t = 0; t < nblk; t++) {
+                double *y = buf + off[t];
+                mwIndex j, l;
+                mwSize r;
+
+                memset(y, 0, (rhi[t] - rlo[t])*p*sizeof(double));
+                for (j = blk[t]; j < blk[t+1]; j++) {
+                    double b[SMVP_PANEL];
+                    for (r = 0; r < w; r++) { b[r] = B[j + (r0+r)*n]; }
+                    for (l = jc[j]; l < jc[j+1]; l++) {
+                        double *yl = y + (ir[l] - rlo[t])*p;
+                        for (r = 0; r < w; r++) { yl[r] += s[l]*b[r]; }
+                    }
+                }
+            }
+
+            /* Sum the buffers row wise. */
+            #pragma omp parallel for schedule(static)
+            for (i = 0; i < (mwSignedIndex) m; i++) {
+                mwSize r;
+                int u;
+                for (u = 0; u < nblk; u++) {
+                    if (((mwIndex) i >= rlo[u]) && ((mwIndex) i < rhi[u])) {
+                        const double *yl = buf + off[u] + (i - rlo[u])*p;
+                        for (r = 0; r < w; r++) { X[i + (r0+r)*m] += yl[r]; }
+                    }
+                }
+            }
+        }
+
+        mxFree(buf);
+        mxFree(off);
+        mxFree(rhi);
+        mxFree(rlo);
+        mxFree(blk);
+    }
+}
@@ -3,9 +3,12 @@ function smvp
 % Dedicated mex-file for Sparse-Matrix-Vector-Products (smvp)
 %
 %   x = smvp(A,b);
+%   x = smvp(A,b,'t');
 %
-% This function is the same as x = A*b, for sparse A and dense vector input
-% b, but is generally much faster.
+% This function is the same as x = A*b (or x = A'*b), for sparse A and dense
+% input b, but is generally much faster. b may have several columns, they are
+% multiplied in one sweep over A. The products run on multiple threads if the
+% mex-file is compiled with OpenMP support.
 %
 % The speed increase is probably only important for large problems that
 % need to be solved repeatedly.
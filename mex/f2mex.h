@@ -23,6 +23,10 @@ extern void mexconst_stencil2sparse (int64_t, int64_t, int64_t *, int64_t *, int
 
 extern void mexstencil2sparse (int64_t, int64_t *, int64_t *, int64_t *, double *, int64_t *, int64_t *, double *);
 
+extern void mexlaplace_5p_sparse_size (int64_t, int64_t *, int64_t *);
+
+extern void mexlaplace_5p_sparse_coo (int64_t, int64_t, int64_t *, int64_t, int64_t *, int64_t *, double *);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,503 @@
+// Copyright (C) 2015 Laurent Hoeltgen <hoeltgen@b-tu.de>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Native version of OptimalControl/FindMask.m for the Laplace operator.
+ *
+ * findmask [options] -lambda l image.pgm out
+ *      Optimises the mask of image.pgm (or .ppm) and writes the thresholded
+ *      mask to out-mask.pgm and the reconstruction from it to out-rec.pgm (or
+ *      .ppm).
+ * findmask [options] -lambda l -d indir outdir
+ *      Does the same for every PGM and PPM image in indir. The results of
+ *      indir/name.pgm are written to outdir/name-mask.pgm and
+ *      outdir/name-rec.pgm.
+ *
+ * The options are those of FindMask.m with the same defaults:
+ *
+ *      -mu 1.25 -e 1e-4 -maxit 1 -PockIt 25000 -PockTol 1e-12 -PockGamma 0
+ *      -PockAdapt 0.5 -PockPrecision double -PockPolish 1
+ *
+ * and -threshold 0.01 for the threshold of the mask. Colour images are
+ * optimised on their luma. Every channel is then reconstructed with the same
+ * mask. With -mfb 1, the mask is also written to out-mask.mfb, a width x height
+ * grid of doubles in the binary container of mfbin.h that other programs can
+ * map without parsing the image.
+ *
+ * The outer iterations are those of FindMask.m. The linearised problems are
+ * solved by the matrix free PDHG solver of PockChambolleMex with a persistent
+ * workspace, e.g. with warm starts. The inpainting equations are solved with
+ * UMFPACK (solve_inpainting_coo). The Laplacian comes from mod_laplace. Its
+ * sparsity pattern is shared by all inpainting matrices of an image, so that
+ * the symbolic factorisation is only computed once per image.
+ *
+ * In directory mode, every thread processes one image at a time and takes the
+ * next image as soon as it is done. Reading and writing the images of one
+ * thread thus overlaps with the computations of the others. The loops of the
+ * PDHG solver run on the calling thread only in this mode. For a single image,
+ * they use all threads.
+ */
+
+#include <ctype.h>
+#include <dirent.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "pdhg.h"
+#include "f2mex.h"
+#include "inpaintumf.h"
+#include "mfbin.h"
+#include "pnm.h"
+
+typedef struct {
+    int    maxit;        /* Number of outer iterations.                     */
+    double threshold;    /* Threshold for the mask.                         */
+    int    mfb;          /* Whether to write the mask to out-mask.mfb.      */
+    pdhgpar par;         /* Parameters of the linearised problems.          */
+} fmopts;
+
+/* The Laplacian D in COO format (0 based, sorted by rows) and the entries of
+ * the inpainting matrix M(c) = diag(c) - (I - diag(c))*D with the same
+ * pattern. alloc is the next flag for solve_inpainting_coo. */
+typedef struct {
+    long n, nz;
+    long *ir, *jc;
+    double *d, *a;
+    long alloc;
+} fmsystem;
+
+/* Statistics of an image. */
+typedef struct {
+    int    outer, inner; /* Outer iterations and PDHG iterations.           */
+    double density;      /* Density of the thresholded mask in percent.     */
+    double mse;          /* Mean squared error of the reconstruction.       */
+} fmstats;
+
+static double fm_time(void)
+{
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double) clock()/CLOCKS_PER_SEC;
+#endif
+}
+
+static int fm_system(
+        fmsystem *sys,
+        long n1,
+        long n2)
+{
+    int64_t dims[2] = { n1, n2 }, nz, k;
+    int64_t *ir, *jc;
+
+    mexlaplace_5p_sparse_size(2, dims, &nz);
+
+    sys->n     = n1*n2;
+    sys->nz    = (long) nz;
+    sys->ir    = malloc(nz*sizeof(long));
+    sys->jc    = malloc(nz*sizeof(long));
+    sys->d     = malloc(nz*sizeof(double));
+    sys->a     = malloc(nz*sizeof(double));
+    sys->alloc = 1;
+    ir = malloc(nz*sizeof(int64_t));
+    jc = malloc(nz*sizeof(int64_t));
+    if (!sys->ir || !sys->jc || !sys->d || !sys->a || !ir || !jc) {
+        free(ir); free(jc);
+        return -1;
+    }
+
+    mexlaplace_5p_sparse_coo(2, nz, dims, 1, ir, jc, sys->d);
+    for (k = 0; k < nz; k++) {
+        sys->ir[k] = (long) ir[k] - 1;
+        sys->jc[k] = (long) jc[k] - 1;
+    }
+    free(ir);
+    free(jc);
+    return 0;
+}
+
+static void fm_system_free(
+        fmsystem *sys)
+{
+    long alloc = -1;
+
+    if (sys->alloc == 0) {
+        solve_inpainting_coo(&sys->n, &sys->nz, sys->ir, sys->jc, sys->a, NULL, NULL, &alloc);
+    }
+    free(sys->ir);
+    free(sys->jc);
+    free(sys->d);
+    free(sys->a);
+}
+
+/* y = D*x. */
+static void fm_laplace(
+        const fmsystem *sys,
+        const double *x,
+        double *y)
+{
+    long k;
+
+    memset(y, 0, sys->n*sizeof(double));
+    for (k = 0; k < sys->nz; k++) {
+        y[sys->ir[k]] += sys->d[k]*x[sys->jc[k]];
+    }
+}
+
+/* Solves M(c)*x = c.*f. */
+static void fm_inpaint(
+        fmsystem *sys,
+        const double *c,
+        const double *f,
+        double *rhs,
+        double *x)
+{
+    long k;
+
+    for (k = 0; k < sys->nz; k++) {
+        long i = sys->ir[k];
+        sys->a[k] = (i == sys->jc[k] ? c[i] : 0.0) - (1.0 - c[i])*sys->d[k];
+    }
+    for (k = 0; k < sys->n; k++) {
+        rhs[k] = c[k]*f[k];
+        x[k]   = 0.0;
+    }
+    solve_inpainting_coo(&sys->n, &sys->nz, sys->ir, sys->jc, sys->a, rhs, x, &sys->alloc);
+    sys->alloc = 0;
+}
+
+static double fm_dist(
+        const double *x,
+        const double *y,
+        long n)
+{
+    double s = 0.0;
+    long k;
+
+    for (k = 0; k < n; k++) { s += (x[k] - y[k])*(x[k] - y[k]); }
+    return sqrt(s);
+}
+
+/* The outer iterations of FindMask.m for the image f on an n1 x n2 grid. The
+ * thresholded mask is returned in cT.
+ */
+static void fm_optimise(
+        const fmopts *o,
+        fmsystem *sys,
+        long n1,
+        long n2,
+        const double *f,
+        double *cT,
+        fmstats *st)
+{
+    long N = n1*n2, k;
+    int i, nlow;
+    double du, dc;
+    double *c, *cbar, *u, *ubar, *Du, *bb, *g;
+    inpaintop op;
+    pdhgws ws;
+
+    c    = mxCalloc(N, sizeof(double));
+    cbar = mxCalloc(N, sizeof(double));
+    u    = mxCalloc(N, sizeof(double));
+    ubar = mxCalloc(N, sizeof(double));
+    Du   = mxCalloc(N, sizeof(double));
+    bb   = mxCalloc(N, sizeof(double));
+    g    = mxCalloc(N, sizeof(double));
+    pdhg_alloc(&ws, N);
+
+    st->outer = 0;
+    st->inner = 0;
+
+    for (i = 1; i <= o->maxit; i++) {
+        if ((i > 1) && (fm_dist(c, cbar, N) < 1e-15)) { break; }
+
+        /* Start with a full mask, then take the mask and the solution from
+         * the previous iteration. */
+        if (i == 1) {
+            for (k = 0; k < N; k++) { cbar[k] = 1.0; }
+            fm_inpaint(sys, cbar, f, Du, ubar);
+        } else {
+            memcpy(cbar, c, N*sizeof(double));
+            memcpy(ubar, u, N*sizeof(double));
+        }
+
+        /* B = u - f + D*u and g = c.*(I+D)*u. */
+        fm_laplace(sys, ubar, Du);
+        for (k = 0; k < N; k++) {
+            bb[k] = ubar[k] - f[k] + Du[k];
+            g[k]  = cbar[k]*(ubar[k] + Du[k]);
+        }
+
+        inpaintop_grid(&op, INPAINTOP_LAPLACE, n1, n2, cbar);
+        pdhg_norm(&ws, &op, bb, PDHG_NRMIT, PDHG_NRMTOL, 1, NULL);
+        st->inner += pdhg_solve(&ws, &op, f, cbar, bb, g, &o->par, &du, &dc, &nlow);
+        inpaintop_free(&op);
+        memcpy(c, ws.c, N*sizeof(double));
+
+        /* Solution and thresholded mask for the new mask. If c is 0, the
+         * solution must be 0. */
+        memset(u, 0, N*sizeof(double));
+        if (fm_dist(c, u, N) < 100*DBL_EPSILON) {
+            memset(cT, 0, N*sizeof(double));
+        } else {
+            fm_inpaint(sys, c, f, Du, u);
+            for (k = 0; k < N; k++) { cT[k] = fabs(c[k]) > o->threshold ? 1.0 : 0.0; }
+        }
+        st->outer = i;
+    }
+
+    pdhg_free(&ws);
+    mxFree(c);
+    mxFree(cbar);
+    mxFree(u);
+    mxFree(ubar);
+    mxFree(Du);
+    mxFree(bb);
+    mxFree(g);
+}
+
+/* Optimises the mask of the image in the file in and writes the results to
+ * out-mask.pgm (and out-mask.mfb) and out-rec.pgm (or .ppm). Returns 0 on
+ * success.
+ */
+static int fm_image(
+        const fmopts *o,
+        const char *in,
+        const char *out)
+{
+    pnmimage img, mask, rec;
+    fmsystem sys;
+    fmstats st;
+    double *f, *rhs, t = fm_time(), err = 0.0;
+    long N, k;
+    int ch, ret = 0;
+    char *file;
+
+    if (pnm_read(in, &img)) { return -1; }
+    N = img.width*img.height;
+
+    file = malloc(strlen(out) + 16);
+    f    = malloc(N*sizeof(double));
+    rhs  = malloc(N*sizeof(double));
+    if (!file || !f || !rhs || fm_system(&sys, img.width, img.height) ||
+            pnm_alloc(&mask, img.width, img.height, 1, 255) ||
+            pnm_alloc(&rec, img.width, img.height, img.channels, img.maxval)) {
+        mexErrMsgTxt("Out of memory.");
+    }
+
+    /* The mask of colour images is optimised on the luma. */
+    for (k = 0; k < N; k++) {
+        f[k] = (img.channels == 3) ?
+            0.299*img.data[k] + 0.587*img.data[N+k] + 0.114*img.data[2*N+k] : img.data[k];
+    }
+
+    fm_optimise(o, &sys, img.width, img.height, f, mask.data, &st);
+
+    /* Without any mask point, the reconstruction is 0. */
+    st.density = 0.0;
+    for (k = 0; k < N; k++) { st.density += mask.data[k]; }
+    for (ch = 0; (ch < img.channels) && (st.density > 0.0); ch++) {
+        fm_inpaint(&sys, mask.data, img.data + ch*N, rhs, rec.data + ch*N);
+    }
+    for (k = 0; k < N*img.channels; k++) {
+        err += (255.0*(rec.data[k] - img.data[k]))*(255.0*(rec.data[k] - img.data[k]));
+    }
+    st.density = 100.0*st.density/N;
+    st.mse     = err/(N*img.channels);
+
+    sprintf(file, "%s-mask.pgm", out);
+    ret |= pnm_write(file, &mask);
+    if (o->mfb) {
+        int64_t dims[2] = { img.width, img.height };
+        sprintf(file, "%s-mask.mfb", out);
+        ret |= mfb_write_grid(file, sizeof(double), 2, dims, mask.data);
+    }
+    sprintf(file, "%s-rec.%s", out, img.channels == 3 ? "ppm" : "pgm");
+    ret |= pnm_write(file, &rec);
+
+    printf("%s: %ld x %ld, %d outer and %d PDHG iterations, density %g%%, MSE %g, %g s.\n",
+            in, img.width, img.height, st.outer, st.inner, st.density, st.mse, fm_time() - t);
+
+    fm_system_free(&sys);
+    pnm_free(&img);
+    pnm_free(&mask);
+    pnm_free(&rec);
+    free(file);
+    free(f);
+    free(rhs);
+    return ret;
+}
+
+static int fm_iequal(
+        const char *s,
+        const char *t)
+{
+    while (*s && (tolower((unsigned char) *s) == tolower((unsigned char) *t))) { s++; t++; }
+    return *s == *t;
+}
+
+static int fm_compare(
+        const void *a,
+        const void *b)
+{
+    return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+/* Returns the sorted names of the PGM and PPM files in dir and their number
+ * in n. */
+static char **fm_list(
+        const char *dir,
+        int *n)
+{
+    DIR *dp = opendir(dir);
+    struct dirent *e;
+    char **names = NULL, **tmp;
+    size_t len;
+    int cap = 0;
+
+    *n = 0;
+    if (!dp) { return NULL; }
+    while ((e = readdir(dp))) {
+        len = strlen(e->d_name);
+        if ((len < 5) || (!fm_iequal(e->d_name + len - 4, ".pgm") &&
+                    !fm_iequal(e->d_name + len - 4, ".ppm") &&
+                    !fm_iequal(e->d_name + len - 4, ".pnm"))) {
+            continue;
+        }
+        if (*n == cap) {
+            cap = cap ? 2*cap : 64;
+            tmp = realloc(names, cap*sizeof(char *));
+            if (!tmp) { mexErrMsgTxt("Out of memory."); }
+            names = tmp;
+        }
+        names[*n] = malloc(len + 1);
+        if (!names[*n]) { mexErrMsgTxt("Out of memory."); }
+        strcpy(names[(*n)++], e->d_name);
+    }
+    closedir(dp);
+    if (*n) { qsort(names, *n, sizeof(char *), fm_compare); }
+    return names;
+}
+
+static void fm_usage(void)
+{
+    fprintf(stderr,
+            "usage: findmask [options] -lambda l image.pgm out\n"
+            "       findmask [options] -lambda l -d indir outdir\n"
+            "options (defaults): -mu 1.25 -e 1e-4 -maxit 1 -threshold 0.01 -PockIt 25000\n"
+            "       -PockTol 1e-12 -PockGamma 0 -PockAdapt 0.5 -PockPrecision double\n"
+            "       -PockPolish 1 -mfb 0\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(
+        int argc,
+        char **argv)
+{
+    fmopts o;
+    const char *in = NULL, *out = NULL;
+    int k, dir = 0, fails = 0;
+
+    o.maxit      = 1;
+    o.threshold  = 0.01;
+    o.mfb        = 0;
+    o.par.reg    = PDHG_L1;
+    o.par.eps    = 1e-4;
+    o.par.mu     = 1.25;
+    o.par.lambda = -1.0;
+    o.par.kappa  = 1.0;
+    o.par.L      = 25000;
+    o.par.tol    = 1e-12;
+    o.par.gamma  = 0.0;
+    o.par.alpha  = 0.5;
+    o.par.prec   = PDHG_DOUBLE;
+    o.par.polish = 1;
+
+    for (k = 1; k < argc; k++) {
+        const char *a = argv[k];
+
+        if (fm_iequal(a, "-d")) {
+            dir = 1;
+        } else if ((a[0] == '-') && (k+1 < argc)) {
+            const char *v = argv[++k];
+            if      (fm_iequal(a, "-lambda"))    { o.par.lambda = atof(v); }
+            else if (fm_iequal(a, "-mu"))        { o.par.mu     = atof(v); }
+            else if (fm_iequal(a, "-e"))         { o.par.eps    = atof(v); }
+            else if (fm_iequal(a, "-maxit"))     { o.maxit      = atoi(v); }
+            else if (fm_iequal(a, "-threshold")) { o.threshold  = atof(v); }
+            else if (fm_iequal(a, "-mfb"))       { o.mfb        = atoi(v) != 0; }
+            else if (fm_iequal(a, "-PockIt"))    { o.par.L      = atof(v); }
+            else if (fm_iequal(a, "-PockTol"))   { o.par.tol    = atof(v); }
+            else if (fm_iequal(a, "-PockGamma")) { o.par.gamma  = atof(v); }
+            else if (fm_iequal(a, "-PockAdapt")) { o.par.alpha  = atof(v); }
+            else if (fm_iequal(a, "-PockPolish")) { o.par.polish = atoi(v) != 0; }
+            else if (fm_iequal(a, "-PockPrecision")) {
+                if      (fm_iequal(v, "double")) { o.par.prec = PDHG_DOUBLE; }
+                else if (fm_iequal(v, "single")) { o.par.prec = PDHG_SINGLE; }
+                else if (fm_iequal(v, "mixed"))  { o.par.prec = PDHG_MIXED; }
+                else { fm_usage(); }
+            }
+            else { fm_usage(); }
+        } else if (!in) {
+            in = a;
+        } else if (!out) {
+            out = a;
+        } else {
+            fm_usage();
+        }
+    }
+    if (!in || !out || (o.par.lambda < 0.0) || (o.maxit < 0) ||
+            (o.par.alpha < 0.0) || (o.par.alpha >= 1.0)) {
+        fm_usage();
+    }
+
+    if (!dir) {
+        return fm_image(&o, in, out) ? EXIT_FAILURE : EXIT_SUCCESS;
+    } else {
+        int n;
+        char **names = fm_list(in, &n);
+
+        if (!n) {
+            fprintf(stderr, "%s: no PGM or PPM images found.\n", in);
+            return EXIT_FAILURE;
+        }
+
+        /* One image per thread, see above. */
+        #pragma omp parallel for schedule(dynamic, 1) reduction(+:fails)
+        for (k = 0; k < n; k++) {
+            size_t len = strlen(names[k]);
+            char *src = malloc(strlen(in)  + len + 2);
+            char *dst = malloc(strlen(out) + len + 2);
+
+            if (!src || !dst) { mexErrMsgTxt("Out of memory."); }
+            sprintf(src, "%s/%s", in, names[k]);
+            sprintf(dst, "%s/%.*s", out, (int) len - 4, names[k]);
+            fails += fm_image(&o, src, dst) != 0;
+
+            free(src);
+            free(dst);
+            free(names[k]);
+        }
+        free(names);
+        return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+}
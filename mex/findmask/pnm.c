@@ -0,0 +1,192 @@
+// Copyright (C) 2015 Laurent Hoeltgen <hoeltgen@b-tu.de>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pnm.h"
+
+/* Reads the next number of the header, skipping white space and comments. */
+static int pnm_number(
+        FILE *fp,
+        long *val)
+{
+    int ch;
+
+    for (;;) {
+        ch = fgetc(fp);
+        if (ch == '#') {
+            while ((ch != EOF) && (ch != '\n') && (ch != '\r')) {
+                ch = fgetc(fp);
+            }
+        }
+        if (ch == EOF) {
+            return -1;
+        }
+        if (!isspace(ch)) {
+            break;
+        }
+    }
+    if (!isdigit(ch)) {
+        return -1;
+    }
+
+    *val = 0;
+    while (isdigit(ch)) {
+        *val = 10*(*val) + (ch - '0');
+        if (*val > 1000000000L) {
+            return -1;
+        }
+        ch = fgetc(fp);
+    }
+    /* Exactly one white space character separates the header from binary data. */
+    if ((ch != EOF) && !isspace(ch)) {
+        ungetc(ch, fp);
+    }
+    return 0;
+}
+
+int pnm_alloc(
+        pnmimage *img,
+        long width,
+        long height,
+        int channels,
+        int maxval)
+{
+    img->width    = width;
+    img->height   = height;
+    img->channels = channels;
+    img->maxval   = maxval;
+    img->data     = calloc((size_t) channels*width*height, sizeof(double));
+    return img->data ? 0 : -1;
+}
+
+void pnm_free(
+        pnmimage *img)
+{
+    free(img->data);
+    img->data = NULL;
+}
+
+int pnm_read(
+        const char *file,
+        pnmimage *img)
+{
+    FILE *fp;
+    int type, ch, bytes;
+    long w, h, maxval, val, k, l, n;
+    unsigned char *row = NULL;
+
+    img->data = NULL;
+    fp = fopen(file, "rb");
+    if (!fp) {
+        fprintf(stderr, "%s: cannot open file.\n", file);
+        return -1;
+    }
+
+    if ((fgetc(fp) != 'P') || ((type = fgetc(fp)) == EOF) ||
+            ((type != '2') && (type != '3') && (type != '5') && (type != '6')) ||
+            pnm_number(fp, &w) || pnm_number(fp, &h) || pnm_number(fp, &maxval) ||
+            (w < 1) || (h < 1) || (maxval < 1) || (maxval > 65535)) {
+        fprintf(stderr, "%s: not a PGM or PPM image.\n", file);
+        fclose(fp);
+        return -1;
+    }
+
+    ch = ((type == '3') || (type == '6')) ? 3 : 1;
+    if (pnm_alloc(img, w, h, ch, (int) maxval)) {
+        fprintf(stderr, "%s: out of memory.\n", file);
+        fclose(fp);
+        return -1;
+    }
+
+    /* The file interleaves the channels, img holds them one after another. */
+    n = w*h;
+    bytes = (maxval > 255) ? 2 : 1;
+    if ((type == '5') || (type == '6')) {
+        row = malloc((size_t) bytes*ch*w);
+    }
+
+    for (k = 0; k < h; k++) {
+        if (row && (fread(row, (size_t) bytes*ch, (size_t) w, fp) != (size_t) w)) {
+            goto truncated;
+        }
+        for (l = 0; l < w*ch; l++) {
+            if (row) {
+                /* Two byte values are stored most significant byte first. */
+                val = (bytes == 2) ? 256*row[2*l] + row[2*l+1] : row[l];
+            } else if (pnm_number(fp, &val)) {
+                goto truncated;
+            }
+            img->data[(l % ch)*n + k*w + l/ch] = (double) (val > maxval ? maxval : val)/maxval;
+        }
+    }
+
+    free(row);
+    fclose(fp);
+    return 0;
+
+truncated:
+    fprintf(stderr, "%s: file is truncated.\n", file);
+    free(row);
+    fclose(fp);
+    pnm_free(img);
+    return -1;
+}
+
+int pnm_write(
+        const char *file,
+        const pnmimage *img)
+{
+    FILE *fp;
+    unsigned char *row;
+    long k, l, n = img->width*img->height, val;
+    int ch = img->channels, bytes = (img->maxval > 255) ? 2 : 1, err;
+    double x;
+
+    fp = fopen(file, "wb");
+    row = malloc((size_t) bytes*ch*img->width);
+    if (!fp || !row) {
+        fprintf(stderr, "%s: cannot write file.\n", file);
+        if (fp) {
+            fclose(fp);
+        }
+        free(row);
+        return -1;
+    }
+
+    err = fprintf(fp, "P%c\n%ld %ld\n%d\n", ch == 3 ? '6' : '5', img->width, img->height, img->maxval) < 0;
+    for (k = 0; (k < img->height) && !err; k++) {
+        for (l = 0; l < img->width*ch; l++) {
+            x = img->data[(l % ch)*n + k*img->width + l/ch];
+            x = (x < 0.0) ? 0.0 : ((x > 1.0) ? 1.0 : x);
+            val = (long) (x*img->maxval + 0.5);
+            if (bytes == 2) {
+                row[2*l]   = (unsigned char) (val >> 8);
+                row[2*l+1] = (unsigned char) (val & 255);
+            } else {
+                row[l] = (unsigned char) val;
+            }
+        }
+        err = fwrite(row, (size_t) bytes*ch, (size_t) img->width, fp) != (size_t) img->width;
+    }
+
+    free(row);
+    if (fclose(fp) || err) {
+        fprintf(stderr, "%s: cannot write file.\n", file);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+// Copyright (C) 2015 Laurent Hoeltgen <hoeltgen@b-tu.de>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PNM_H
+#define PNM_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Grey value (PGM) or colour (PPM) image. The channels are stored one after
+   * another, each row by row. The grey values are scaled to [0, 1].
+   */
+  typedef struct
+  {
+    long width, height;
+    int channels;       /* 1 for PGM, 3 for PPM. */
+    int maxval;         /* Maximal grey value in the file, at most 65535. */
+    double *data;       /* channels * width * height entries. */
+  } pnmimage;
+
+  /*
+   * Reads an ASCII (P2, P3) or binary (P5, P6) image. Returns 0 on success and
+   * -1 otherwise, in which case a message has been printed to stderr.
+   */
+  int pnm_read(const char *file, pnmimage *img);
+
+  /*
+   * Writes the image in the binary format, with the grey values clamped to
+   * [0, 1] and rounded to img->maxval.
+   */
+  int pnm_write(const char *file, const pnmimage *img);
+
+  /* Allocates the data of an image of the given size. Returns 0 on success. */
+  int pnm_alloc(pnmimage *img, long width, long height, int channels, int maxval);
+
+  void pnm_free(pnmimage *img);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PNM_H */
@@ -6,7 +6,9 @@ program fruit_driver
     ! use :: test_gvo
     ! use :: test_img_fun
     ! use :: test_inpainting
-    ! use :: test_laplace
+    use :: test_laplace
+    use :: test_linsolve
+    use :: test_mfbin
     use :: test_miscfun
     use :: test_sparse
     use :: test_stencil
@@ -186,32 +188,41 @@ program fruit_driver
 
     ! !! laplace
 
-    ! call setup_test_laplace
-    ! write (*,*) ".. running test: check_stencil_laplace_5p"
-    ! call set_unit_name('check_stencil_laplace_5p')
-    ! call run_test_case(check_stencil_laplace_5p, "check_stencil_laplace_5p")
-    ! write (*,*)
-    ! write (*,*) ".. done."
-    ! write (*,*) ""
-    ! call teardown_test_laplace
+    call setup_test_laplace
+    write (*,*) ".. running test: check_stencil_laplace_5p"
+    call set_unit_name('check_stencil_laplace_5p')
+    call run_test_case(check_stencil_laplace_5p, "check_stencil_laplace_5p")
+    write (*,*)
+    write (*,*) ".. done."
+    write (*,*) ""
+    call teardown_test_laplace
 
-    ! call setup_test_laplace
-    ! write (*,*) ".. running test: check_laplace_5p_sparse_coo"
-    ! call set_unit_name('check_laplace_5p_sparse_coo')
-    ! call run_test_case(check_laplace_5p_sparse_coo, "check_laplace_5p_sparse_coo")
-    ! write (*,*)
-    ! write (*,*) ".. done."
-    ! write (*,*) ""
-    ! call teardown_test_laplace
+    call setup_test_laplace
+    write (*,*) ".. running test: check_laplace_5p_sparse_coo"
+    call set_unit_name('check_laplace_5p_sparse_coo')
+    call run_test_case(check_laplace_5p_sparse_coo, "check_laplace_5p_sparse_coo")
+    write (*,*)
+    write (*,*) ".. done."
+    write (*,*) ""
+    call teardown_test_laplace
 
-    ! call setup_test_laplace
-    ! write (*,*) ".. running test: check_apply_laplace_5p"
-    ! call set_unit_name('check_apply_laplace_5p')
-    ! call run_test_case(check_apply_laplace_5p, "check_apply_laplace_5p")
-    ! write (*,*)
-    ! write (*,*) ".. done."
-    ! write (*,*) ""
-    ! call teardown_test_laplace
+    call setup_test_laplace
+    write (*,*) ".. running test: check_apply_laplace_5p"
+    call set_unit_name('check_apply_laplace_5p')
+    call run_test_case(check_apply_laplace_5p, "check_apply_laplace_5p")
+    write (*,*)
+    write (*,*) ".. done."
+    write (*,*) ""
+    call teardown_test_laplace
+
+    call setup_test_laplace
+    write (*,*) ".. running test: check_laplace_omp"
+    call set_unit_name('check_laplace_omp')
+    call run_test_case(check_laplace_omp, "check_laplace_omp")
+    write (*,*)
+    write (*,*) ".. done."
+    write (*,*) ""
+    call teardown_test_laplace
 
     ! !! miscfun
 
@@ -316,6 +327,15 @@ program fruit_driver
     write(*,*) ""
     call teardown_test_sparse
 
+    call setup_test_sparse
+    write(*,*) ".. running test: check_coocsrsum"
+    call set_unit_name('check_coocsrsum')
+    call run_test_case(check_coocsrsum, "check_coocsrsum")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
     call setup_test_sparse
     write(*,*) ".. running test: check_csrcoo"
     call set_unit_name('check_csrcoo')
@@ -342,6 +362,15 @@ program fruit_driver
     write(*,*) ".. done."
     write(*,*) ""
     call teardown_test_sparse
+
+    call setup_test_sparse
+    write(*,*) ".. running test: check_diamuanum"
+    call set_unit_name('check_diamuanum')
+    call run_test_case(check_diamuanum, "check_diamuanum")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
     
     call setup_test_sparse
     write(*,*) ".. running test: check_amux"
@@ -352,6 +381,15 @@ program fruit_driver
     write(*,*) ""
     call teardown_test_sparse
 
+    call setup_test_sparse
+    write(*,*) ".. running test: check_amuxt"
+    call set_unit_name('check_amuxt')
+    call run_test_case(check_amuxt, "check_amuxt")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
     call setup_test_sparse
     write(*,*) ".. running test: check_aplb"
     call set_unit_name('check_aplb')
@@ -361,6 +399,42 @@ program fruit_driver
     write(*,*) ""
     call teardown_test_sparse
 
+    call setup_test_sparse
+    write(*,*) ".. running test: check_aplbsym"
+    call set_unit_name('check_aplbsym')
+    call run_test_case(check_aplbsym, "check_aplbsym")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
+    call setup_test_sparse
+    write(*,*) ".. running test: check_aplbnum"
+    call set_unit_name('check_aplbnum')
+    call run_test_case(check_aplbnum, "check_aplbnum")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
+    call setup_test_sparse
+    write(*,*) ".. running test: check_amub"
+    call set_unit_name('check_amub')
+    call run_test_case(check_amub, "check_amub")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
+    call setup_test_sparse
+    write(*,*) ".. running test: check_atda"
+    call set_unit_name('check_atda')
+    call run_test_case(check_atda, "check_atda")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
     call setup_test_sparse
     write(*,*) ".. running test: check_csrsort"
     call set_unit_name('check_csrsort')
@@ -369,6 +443,127 @@ program fruit_driver
     write(*,*) ".. done."
     write(*,*) ""
     call teardown_test_sparse
+
+    call setup_test_sparse
+    write(*,*) ".. running test: check_csrdia"
+    call set_unit_name('check_csrdia')
+    call run_test_case(check_csrdia, "check_csrdia")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
+    call setup_test_sparse
+    write(*,*) ".. running test: check_amuxd"
+    call set_unit_name('check_amuxd')
+    call run_test_case(check_amuxd, "check_amuxd")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
+    call setup_test_sparse
+    write(*,*) ".. running test: check_csrrcm"
+    call set_unit_name('check_csrrcm')
+    call run_test_case(check_csrrcm, "check_csrrcm")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
+    call setup_test_sparse
+    write(*,*) ".. running test: check_gridnd"
+    call set_unit_name('check_gridnd')
+    call run_test_case(check_gridnd, "check_gridnd")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
+    call setup_test_sparse
+    write(*,*) ".. running test: check_csrperm"
+    call set_unit_name('check_csrperm')
+    call run_test_case(check_csrperm, "check_csrperm")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_sparse
+
+    !! linsolve
+
+    call setup_test_linsolve
+    write(*,*) ".. running test: check_pcjacobi"
+    call set_unit_name('check_pcjacobi')
+    call run_test_case(check_pcjacobi, "check_pcjacobi")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_linsolve
+
+    call setup_test_linsolve
+    write(*,*) ".. running test: check_pcssor"
+    call set_unit_name('check_pcssor')
+    call run_test_case(check_pcssor, "check_pcssor")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_linsolve
+
+    call setup_test_linsolve
+    write(*,*) ".. running test: check_pcilu0"
+    call set_unit_name('check_pcilu0')
+    call run_test_case(check_pcilu0, "check_pcilu0")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_linsolve
+
+    call setup_test_linsolve
+    write(*,*) ".. running test: check_cg"
+    call set_unit_name('check_cg')
+    call run_test_case(check_cg, "check_cg")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_linsolve
+
+    call setup_test_linsolve
+    write(*,*) ".. running test: check_bicgstab"
+    call set_unit_name('check_bicgstab')
+    call run_test_case(check_bicgstab, "check_bicgstab")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_linsolve
+
+    call setup_test_linsolve
+    write(*,*) ".. running test: check_gmres"
+    call set_unit_name('check_gmres')
+    call run_test_case(check_gmres, "check_gmres")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_linsolve
+
+    !! mfbin
+
+    call setup_test_mfbin
+    write(*,*) ".. running test: check_mfbin_csr"
+    call set_unit_name('check_mfbin_csr')
+    call run_test_case(check_mfbin_csr, "check_mfbin_csr")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_mfbin
+
+    call setup_test_mfbin
+    write(*,*) ".. running test: check_mfbin_grid"
+    call set_unit_name('check_mfbin_grid')
+    call run_test_case(check_mfbin_grid, "check_mfbin_grid")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_mfbin
     
     
     ! !! stencil
@@ -427,41 +622,77 @@ program fruit_driver
     ! write(*,*) ""
     ! call teardown_test_stencil
 
-    ! call setup_test_stencil
-    ! write (*,*) ".. running test: check_stencil2sparse_size"
-    ! call set_unit_name('check_stencil2sparse_size')
-    ! call run_test_case(check_stencil2sparse_size, "check_stencil2sparse_size")
-    ! write(*,*) ""
-    ! write(*,*) ".. done."
-    ! write(*,*) ""
-    ! call teardown_test_stencil
+    call setup_test_stencil
+    write (*,*) ".. running test: check_stencil2sparse_size"
+    call set_unit_name('check_stencil2sparse_size')
+    call run_test_case(check_stencil2sparse_size, "check_stencil2sparse_size")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_stencil
 
-    ! call setup_test_stencil
-    ! write (*,*) ".. running test: check_const_stencil2sparse"
-    ! call set_unit_name('check_const_stencil2sparse')
-    ! call run_test_case(check_const_stencil2sparse, "check_const_stencil2sparse")
-    ! write(*,*) ""
-    ! write(*,*) ".. done."
-    ! write(*,*) ""
-    ! call teardown_test_stencil
+    call setup_test_stencil
+    write (*,*) ".. running test: check_const_stencil2sparse"
+    call set_unit_name('check_const_stencil2sparse')
+    call run_test_case(check_const_stencil2sparse, "check_const_stencil2sparse")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_stencil
 
-    ! call setup_test_stencil
-    ! write (*,*) ".. running test: check_stencil2sparse"
-    ! call set_unit_name('check_stencil2sparse')
-    ! call run_test_case(check_stencil2sparse, "check_stencil2sparse")
-    ! write(*,*) ""
-    ! write(*,*) ".. done."
-    ! write(*,*) ""
-    ! call teardown_test_stencil
+    call setup_test_stencil
+    write (*,*) ".. running test: check_stencil2sparse"
+    call set_unit_name('check_stencil2sparse')
+    call run_test_case(check_stencil2sparse, "check_stencil2sparse")
+    write(*,*) ""
+    write(*,*) ".. done."
+    write(*,*) ""
+    call teardown_test_stencil
 
-    ! call setup_test_stencil
-    ! write (*,*) ".. running test: check_convolve"
-    ! call set_unit_name('check_convolve')
-    ! call run_test_case(check_convolve, "check_convolve")
-    ! write (*,*)
-    ! write (*,*) ".. done."
-    ! write (*,*) ""
-    ! call teardown_test_stencil
+    call setup_test_stencil
+    write (*,*) ".. running test: check_stencil2sparse_omp"
+    call set_unit_name('check_stencil2sparse_omp')
+    call run_test_case(check_stencil2sparse_omp, "check_stencil2sparse_omp")
+    write (*,*)
+    write (*,*) ".. done."
+    write (*,*) ""
+    call teardown_test_stencil
+
+    call setup_test_stencil
+    write (*,*) ".. running test: check_convolve"
+    call set_unit_name('check_convolve')
+    call run_test_case(check_convolve, "check_convolve")
+    write (*,*)
+    write (*,*) ".. done."
+    write (*,*) ""
+    call teardown_test_stencil
+
+    call setup_test_stencil
+    write (*,*) ".. running test: check_sepconvolve"
+    call set_unit_name('check_sepconvolve')
+    call run_test_case(check_sepconvolve, "check_sepconvolve")
+    write (*,*)
+    write (*,*) ".. done."
+    write (*,*) ""
+    call teardown_test_stencil
+
+    call setup_test_stencil
+    write (*,*) ".. running test: check_convolve_omp"
+    call set_unit_name('check_convolve_omp')
+    call run_test_case(check_convolve_omp, "check_convolve_omp")
+    write (*,*)
+    write (*,*) ".. done."
+    write (*,*) ""
+    call teardown_test_stencil
+
+    call setup_test_stencil
+    write (*,*) ".. running test: check_fixconvolve"
+    call set_unit_name('check_fixconvolve')
+    call run_test_case(check_fixconvolve, "check_fixconvolve")
+    write (*,*)
+    write (*,*) ".. done."
+    write (*,*) ""
+    call teardown_test_stencil
 
     ! call setup_test_stencil
     ! write (*,*) ".. running test: check_create_5p_stencil"
@@ -18,6 +18,14 @@
 
 #include <inpaintumf.h>
 
+/* The factorisation is kept between the calls. It is stored per thread, such
+ * that several threads can solve independent problems at the same time. */
+#if defined(_MSC_VER)
+#define INPAINTUMF_TLS __declspec(thread)
+#else
+#define INPAINTUMF_TLS _Thread_local
+#endif
+
 /*
  * alloc ==  2: routine will only be called a single time, perform everything (alloc, computations and free).
  * alloc ==  1: perform allocation and symbolic decomposition (alloc, computations, no free).
@@ -30,10 +38,10 @@ void solve_inpainting_coo(long *n, long *nz, long *ir, long *jc, double *a, doub
         double Info[UMFPACK_INFO];
         double Control[UMFPACK_CONTROL];
         SuiteSparse_long status;
-        static void *Symbolic;
+        static INPAINTUMF_TLS void *Symbolic;
         void *Numeric;
-        static long   *Ap, *Ai;
-        static double *Ax;
+        static INPAINTUMF_TLS long   *Ap, *Ai;
+        static INPAINTUMF_TLS double *Ax;
 
         /* Allocation must be done at first invocation (alloc == 1), bu we keep them in memory for the later calls. */
         if ((*alloc == 1)||(*alloc == 2))
@@ -0,0 +1,276 @@
+// Copyright (C) 2015 Laurent Hoeltgen <hoeltgen@b-tu.de>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+/* 64 bit file offsets for fseeko and ftello on 32 bit systems. */
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ftell returns a long, which has 32 bits on Windows. */
+#if defined(_WIN32)
+#define MFB_NOMMAP
+#define mfb_fseek _fseeki64
+#define mfb_ftell _ftelli64
+#else
+#define mfb_fseek fseeko
+#define mfb_ftell ftello
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <mfbin.h>
+
+#define MFB_HEADER 128
+#define MFB_ALIGN  64
+
+static const char mfb_magic[8] = { 'M', 'F', 'B', 'I', 'N', 'A', 'R', 'Y' };
+
+typedef struct
+{
+        char    magic[8];
+        int32_t version, bom, kind, isize, rsize, ndim;
+        int64_t nnz;
+        int64_t dims[MFB_MAXDIM];
+        int32_t base, reserved[5];
+} mfbheader;
+
+/* Offset of the array after an array of n entries of size bytes at off. */
+static int64_t mfb_next(int64_t off, int64_t n, int size)
+{
+        off += n*size;
+        return (off + MFB_ALIGN - 1)/MFB_ALIGN*MFB_ALIGN;
+}
+
+/* Writes the header followed by the arrays p[0], ..., p[np-1] of n[k] entries
+ * of size[k] bytes. */
+static int mfb_write(const char *file, const mfbheader *h, int np, const void **p, const int64_t *n, const int *size)
+{
+        static const char zero[MFB_ALIGN] = { 0 };
+        FILE *fp;
+        int64_t off = MFB_HEADER, end;
+        int k, err;
+
+        fp = fopen(file, "wb");
+        if (!fp)
+        {
+                fprintf(stderr, "%s: cannot write file.\n", file);
+                return -1;
+        }
+
+        err = fwrite(h, sizeof(*h), 1, fp) != 1;
+        for (k = 0; (k < np) && !err; k++)
+        {
+                err = fwrite(p[k], (size_t) size[k], (size_t) n[k], fp) != (size_t) n[k];
+                end = off + n[k]*size[k];
+                off = mfb_next(off, n[k], size[k]);
+                if ((k+1 < np) && !err)
+                {
+                        err = fwrite(zero, 1, (size_t) (off - end), fp) != (size_t) (off - end);
+                }
+        }
+
+        if (fclose(fp) || err)
+        {
+                fprintf(stderr, "%s: cannot write file.\n", file);
+                return -1;
+        }
+        return 0;
+}
+
+static void mfb_init(mfbheader *h, int kind, int isize, int rsize, int ndim, int64_t nnz, int base)
+{
+        memset(h, 0, sizeof(*h));
+        memcpy(h->magic, mfb_magic, sizeof(mfb_magic));
+        h->version = MFB_VERSION;
+        h->bom     = 0x01020304;
+        h->kind    = kind;
+        h->isize   = isize;
+        h->rsize   = rsize;
+        h->ndim    = ndim;
+        h->nnz     = nnz;
+        h->base    = base;
+}
+
+static int mfb_sparse(const char *file, int kind, int isize, int rsize, int base, int64_t nr, int64_t nc,
+                int64_t nnz, const void *i, const void *j, const void *a)
+{
+        mfbheader h;
+        const void *p[3] = { i, j, a };
+        int64_t n[3] = { kind == MFB_CSR ? nr+1 : nnz, nnz, nnz };
+        int size[3] = { isize, isize, rsize };
+
+        if (((isize != 4) && (isize != 8)) || ((rsize != 4) && (rsize != 8)))
+        {
+                fprintf(stderr, "%s: unsupported index or value size.\n", file);
+                return -1;
+        }
+        mfb_init(&h, kind, isize, rsize, 2, nnz, base);
+        h.dims[0] = nr;
+        h.dims[1] = nc;
+        return mfb_write(file, &h, 3, p, n, size);
+}
+
+int mfb_write_csr(const char *file, int isize, int rsize, int base, int64_t nr, int64_t nc,
+                int64_t nnz, const void *ia, const void *ja, const void *a)
+{
+        return mfb_sparse(file, MFB_CSR, isize, rsize, base, nr, nc, nnz, ia, ja, a);
+}
+
+int mfb_write_coo(const char *file, int isize, int rsize, int base, int64_t nr, int64_t nc,
+                int64_t nnz, const void *ir, const void *jc, const void *a)
+{
+        return mfb_sparse(file, MFB_COO, isize, rsize, base, nr, nc, nnz, ir, jc, a);
+}
+
+int mfb_write_grid(const char *file, int rsize, int ndim, const int64_t *dims, const void *x)
+{
+        mfbheader h;
+        int64_t n = 1;
+        int k;
+
+        if ((ndim < 1) || (ndim > MFB_MAXDIM) || ((rsize != 4) && (rsize != 8)))
+        {
+                fprintf(stderr, "%s: unsupported grid.\n", file);
+                return -1;
+        }
+        for (k = 0; k < ndim; k++) { n *= dims[k]; }
+        mfb_init(&h, MFB_GRID, 0, rsize, ndim, n, 0);
+        memcpy(h.dims, dims, ndim*sizeof(int64_t));
+        return mfb_write(file, &h, 1, &x, &n, &rsize);
+}
+
+int mfb_open(const char *file, mfbin *m)
+{
+        mfbheader h;
+        int64_t len = 0, off, end, n;
+        FILE *fp;
+        const char *base;
+        int ok, k;
+
+        memset(m, 0, sizeof(*m));
+        fp = fopen(file, "rb");
+        if (!fp)
+        {
+                fprintf(stderr, "%s: cannot open file.\n", file);
+                return -1;
+        }
+        ok = (fread(&h, sizeof(h), 1, fp) == 1) && !mfb_fseek(fp, 0, SEEK_END) && ((len = (int64_t) mfb_ftell(fp)) >= 0);
+        ok = ok && !memcmp(h.magic, mfb_magic, sizeof(mfb_magic)) && (h.bom == 0x01020304);
+        if (!ok || (h.version < 1) || (h.version > MFB_VERSION))
+        {
+                fprintf(stderr, "%s: not a container of this version and byte order.\n", file);
+                fclose(fp);
+                return -1;
+        }
+
+        /* Check that all arrays are inside of the file. */
+        ok = ((h.kind == MFB_GRID) && (h.ndim >= 1) && (h.ndim <= MFB_MAXDIM)) ||
+                (((h.kind == MFB_CSR) || (h.kind == MFB_COO)) && (h.ndim == 2) && ((h.isize == 4) || (h.isize == 8)));
+        ok = ok && ((h.rsize == 4) || (h.rsize == 8)) && (h.nnz >= 0) && (h.dims[0] >= 0);
+
+        /* The sizes come from the file. Every array has to fit into the file, so
+         * nnz and dims[0] are bounded by len before they are multiplied, which
+         * keeps the offsets below free of overflows. */
+        ok = ok && (h.nnz <= len/h.rsize);
+        if (ok && (h.kind == MFB_GRID))
+        {
+                /* Stops as soon as the product exceeds nnz. */
+                for (k = 0, n = 1; ok && (k < h.ndim); k++)
+                {
+                        ok = (h.dims[k] >= 0) && ((h.dims[k] == 0) || (n <= h.nnz/h.dims[k]));
+                        n *= h.dims[k];
+                }
+                ok = ok && (n == h.nnz);
+        }
+        else if (ok)
+        {
+                ok = (h.dims[1] >= 0) && (h.nnz <= len/h.isize) && (h.dims[0] < len/h.isize);
+        }
+        off = MFB_HEADER;
+        if (ok && (h.kind != MFB_GRID))
+        {
+                off = mfb_next(off, h.kind == MFB_CSR ? h.dims[0]+1 : h.nnz, h.isize);
+                off = mfb_next(off, h.nnz, h.isize);
+        }
+        end = ok ? off + h.nnz*h.rsize : 0;
+        if (!ok || (end > len))
+        {
+                fprintf(stderr, "%s: file is truncated or corrupt.\n", file);
+                fclose(fp);
+                return -1;
+        }
+
+#ifdef MFB_NOMMAP
+        m->map = malloc((size_t) len);
+        ok = m->map && !mfb_fseek(fp, 0, SEEK_SET) && (fread(m->map, 1, (size_t) len, fp) == (size_t) len);
+        fclose(fp);
+#else
+        fclose(fp);
+        {
+                int fd = open(file, O_RDONLY);
+
+                /* Shared and read only, so that all processes use the pages of the page cache. */
+                m->map = (fd < 0) ? MAP_FAILED : mmap(NULL, (size_t) len, PROT_READ, MAP_SHARED, fd, 0);
+                if (fd >= 0) { close(fd); }
+                ok = m->map != MAP_FAILED;
+                if (!ok) { m->map = NULL; }
+        }
+#endif
+        if (!ok)
+        {
+                fprintf(stderr, "%s: cannot map file.\n", file);
+                mfb_close(m);
+                return -1;
+        }
+
+        m->len   = (size_t) len;
+        m->kind  = h.kind;
+        m->isize = h.isize;
+        m->rsize = h.rsize;
+        m->ndim  = h.ndim;
+        m->base  = h.base;
+        m->nnz   = h.nnz;
+        memcpy(m->dims, h.dims, sizeof(m->dims));
+
+        base = (const char *) m->map;
+        off  = MFB_HEADER;
+        if (h.kind != MFB_GRID)
+        {
+                m->i = base + off;
+                off  = mfb_next(off, h.kind == MFB_CSR ? h.dims[0]+1 : h.nnz, h.isize);
+                m->j = base + off;
+                off  = mfb_next(off, h.nnz, h.isize);
+        }
+        m->x = base + off;
+        return 0;
+}
+
+void mfb_close(mfbin *m)
+{
+        if (m->map)
+        {
+#ifdef MFB_NOMMAP
+                free(m->map);
+#else
+                munmap(m->map, m->len);
+#endif
+        }
+        memset(m, 0, sizeof(*m));
+}
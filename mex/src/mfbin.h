@@ -0,0 +1,95 @@
+// Copyright (C) 2015 Laurent Hoeltgen <hoeltgen@b-tu.de>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MFBIN_H
+#define MFBIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*
+   * Binary container for a sparse matrix in CSR or COO format or a dense grid.
+   * The same files are written and read by the module mfbin (mod_mfbin.fypp).
+   *
+   * The file starts with a header of 128 bytes, all numbers in native byte
+   * order:
+   *
+   *     0  char    magic[8]   "MFBINARY"
+   *     8  int32   version    MFB_VERSION
+   *    12  int32   bom        0x01020304, detects a foreign byte order
+   *    16  int32   kind       MFB_COO, MFB_CSR or MFB_GRID
+   *    20  int32   isize      bytes per index, 4 or 8 (0 for grids)
+   *    24  int32   rsize      bytes per value, 4 or 8
+   *    28  int32   ndim       2 for matrices, 1 to MFB_MAXDIM for grids
+   *    32  int64   nnz        number of stored values
+   *    40  int64   dims[8]    nr and nc for matrices, the grid size otherwise
+   *   104  int32   base       0 or 1, the first row and column index
+   *   108  int32   reserved[5]
+   *
+   * The arrays follow, each at the next multiple of 64 bytes: ia (nr+1), ja
+   * and a (nnz) for CSR, ir, jc and a (nnz) for COO and the values of the grid,
+   * first dimension fastest. Since the arrays are stored as they are used, a
+   * mapping of the file can be used in place and the pages are only read on
+   * first access. Several processes that map the same file share one copy in
+   * the page cache.
+   */
+
+#define MFB_VERSION 1
+#define MFB_MAXDIM  8
+
+  enum { MFB_COO = 1, MFB_CSR = 2, MFB_GRID = 3 };
+
+  typedef struct
+  {
+    int kind, isize, rsize, ndim, base;
+    int64_t nnz;
+    int64_t dims[MFB_MAXDIM];
+    const void *i;      /* ia (CSR) or ir (COO), NULL for grids. */
+    const void *j;      /* ja (CSR) or jc (COO), NULL for grids. */
+    const void *x;      /* Values. */
+    void *map;          /* Mapping (or copy) of the whole file. */
+    size_t len;
+  } mfbin;
+
+  /*
+   * Maps the file read only. The arrays in m point into the mapping and stay
+   * valid until mfb_close. Returns 0 on success and -1 otherwise, in which
+   * case a message has been printed to stderr.
+   */
+  int mfb_open(const char *file, mfbin *m);
+
+  void mfb_close(mfbin *m);
+
+  /*
+   * Write the arrays of a matrix or grid. isize and rsize are the sizes of the
+   * index and value types in bytes. Return 0 on success and -1 otherwise.
+   */
+  int mfb_write_csr(const char *file, int isize, int rsize, int base, int64_t nr, int64_t nc,
+      int64_t nnz, const void *ia, const void *ja, const void *a);
+
+  int mfb_write_coo(const char *file, int isize, int rsize, int base, int64_t nr, int64_t nc,
+      int64_t nnz, const void *ir, const void *jc, const void *a);
+
+  int mfb_write_grid(const char *file, int rsize, int ndim, const int64_t *dims, const void *x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MFBIN_H */
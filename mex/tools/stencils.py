@@ -0,0 +1,41 @@
+import itertools
+
+
+def stenciloffsets(shape, cross=False):
+    '''Returns the offsets of the entries of a stencil.
+
+    Args:
+        shape (tuple): Size of the stencil, all entries odd.
+        cross (bool): Only return the centre and its direct neighbours.
+
+    Returns:
+        list: Offsets as tuples, first dimension fastest.
+    '''
+    half = [s // 2 for s in shape]
+    offs = itertools.product(*[range(-h, h + 1) for h in reversed(half)])
+    offs = [tuple(reversed(o)) for o in offs]
+    if cross:
+        offs = [o for o in offs if sum(abs(x) for x in o) <= 1]
+    return offs
+
+
+def stencilterms(shape, cross, ker, arr, idx, indent):
+    '''Returns the unrolled sum of a convolution with a stencil of fixed size.
+
+    Args:
+        shape (tuple): Size of the stencil, all entries odd.
+        cross (bool): Only use the centre and its direct neighbours.
+        ker (str): Name of the stencil array, which is mirrored.
+        arr (str): Name of the signal array.
+        idx (list): Names of the indices of the current point.
+        indent (int): Indentation of the continuation lines.
+
+    Returns:
+        str: Fortran expression ker(...)*arr(...) + ..., one term per line.
+    '''
+    terms = []
+    for o in stenciloffsets(shape, cross):
+        k = ', '.join(str(s // 2 + 1 - x) for s, x in zip(shape, o))
+        a = ', '.join(i if x == 0 else '{}{:+d}'.format(i, x) for i, x in zip(idx, o))
+        terms.append('{}({})*{}({})'.format(ker, k, arr, a))
+    return (' &\n' + ' ' * indent + '+ ').join(terms)